@@ -0,0 +1,384 @@
+#include "pstack/calc/indexed_mesh.hpp"
+#include "pstack/calc/mesh.hpp"
+#include "pstack/calc/mesh_arrays.hpp"
+#include "pstack/calc/occupancy.hpp"
+#include "pstack/calc/rotations.hpp"
+#include "pstack/calc/sinterbox.hpp"
+#include "pstack/calc/stacker.hpp"
+#include "pstack/calc/voxelize.hpp"
+#include "pstack/files/stl.hpp"
+#include "pstack/synth/shapes.hpp"
+#include "pstack/synth/workload.hpp"
+#include "pstack/util/bit_grid.hpp"
+#include "pstack/util/mdarray.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace pstack::bench {
+
+namespace {
+
+// Formats a parameter value for a benchmark name, like "0.5"
+std::string number(const double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%g", value);
+    return buffer;
+}
+
+// The voxels of a mesh at the given resolution, as the stacker would see them
+util::bit_grid voxels_of(calc::mesh mesh, const double resolution) {
+    mesh.scale(1 / resolution);
+    mesh.set_baseline({ 0, 0, 0 });
+    const auto [x, y, z] = mesh.bounding().box_size;
+    util::mdarray<int, 3> voxels(x, y, z);
+    calc::voxelize(mesh, voxels, 1, 1);
+    util::bit_grid out(x, y, z);
+    for (int i = 0; i != x; ++i) {
+        for (int j = 0; j != y; ++j) {
+            for (int k = 0; k != z; ++k) {
+#if defined(MDSPAN_USE_BRACKET_OPERATOR) and MDSPAN_USE_BRACKET_OPERATOR == 0
+                if (voxels(i, j, k) != 0) {
+#else
+                if (voxels[i, j, k] != 0) {
+#endif
+                    out.set(i, j, k);
+                }
+            }
+        }
+    }
+    return out;
+}
+
+struct result {
+    std::string name;
+    std::size_t iterations; // Per sample
+    std::size_t samples;
+    double min_ns;
+    double median_ns;
+    double mean_ns;
+};
+
+class runner {
+public:
+    runner(std::string filter, const std::size_t samples)
+        : _filter(std::move(filter))
+        , _samples(samples)
+    {}
+
+    // Times `fn`, which does one iteration and returns a value that's kept so the work isn't optimized away.
+    // Fast benchmarks are repeated within each sample, so that every sample takes at least a few milliseconds.
+    template <class F>
+    void run(const std::string& name, F&& fn) {
+        if (name.find(_filter) == std::string::npos) {
+            return;
+        }
+
+        using clock = std::chrono::steady_clock;
+        const auto time = [&](const std::size_t iterations) {
+            const auto start = clock::now();
+            for (std::size_t i = 0; i != iterations; ++i) {
+                _sink = _sink + static_cast<std::size_t>(fn());
+            }
+            return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        };
+
+        static constexpr double min_sample_ns = 5e6;
+        const double first = time(1);
+        const std::size_t iterations = std::max<std::size_t>(1, static_cast<std::size_t>(min_sample_ns / std::max(first, 1.0)));
+
+        std::vector<double> samples{};
+        for (std::size_t i = 0; i != _samples; ++i) {
+            samples.push_back(time(iterations) / iterations);
+        }
+        std::ranges::sort(samples);
+        double total = 0;
+        for (const double sample : samples) {
+            total += sample;
+        }
+        const double median = (samples.size() % 2 == 1)
+            ? samples[samples.size() / 2]
+            : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+
+        _results.push_back({ name, iterations, samples.size(), samples.front(), median, total / samples.size() });
+        std::fprintf(stderr, "%-56s %12.3f ms\n", name.c_str(), median / 1e6);
+    }
+
+    void write_json(std::FILE* file, const std::size_t threads) const {
+        std::fprintf(file, "{\n  \"threads\": %zu,\n  \"benchmarks\": [", threads);
+        for (std::size_t i = 0; i != _results.size(); ++i) {
+            const result& r = _results[i];
+            std::fprintf(file, "%s\n    {\"name\": \"%s\", \"iterations\": %zu, \"samples\": %zu, \"min_ns\": %.1f, \"median_ns\": %.1f, \"mean_ns\": %.1f}",
+                i == 0 ? "" : ",", r.name.c_str(), r.iterations, r.samples, r.min_ns, r.median_ns, r.mean_ns);
+        }
+        std::fprintf(file, "\n  ]\n}\n");
+    }
+
+private:
+    std::string _filter;
+    std::size_t _samples;
+    std::vector<result> _results{};
+    volatile std::size_t _sink = 0;
+};
+
+void bench_mesh(runner& r) {
+    for (const int segments : { 32, 100, 320 }) {
+        const std::string size = std::to_string(2 * segments * segments);
+        calc::mesh mesh = synth::torus(20, 6, segments);
+        r.run("mesh/rotate/triangles=" + size, [&] {
+            mesh.rotate(calc::cubic_rotations[16]);
+            return mesh.triangles().size();
+        });
+        r.run("mesh/bounding/triangles=" + size, [&] {
+            return mesh.bounding().box_size.x;
+        });
+        calc::mesh turned{};
+        r.run("mesh/transform/triangles=" + size, [&] {
+            return mesh.transform(10, calc::cubic_rotations[16], { 0, 0, 0 }, turned).box_size.x;
+        });
+        r.run("indexed_mesh/weld/triangles=" + size, [&] {
+            return calc::indexed_mesh(mesh).vertices().size();
+        });
+        const calc::mesh_arrays arrays{ calc::indexed_mesh(mesh) };
+        calc::mesh_arrays turned_arrays{};
+        r.run("mesh_arrays/transform/triangles=" + size, [&] {
+            return arrays.transform(10, calc::cubic_rotations[16], { 0, 0, 0 }, turned_arrays).box_size.x;
+        });
+    }
+}
+
+void bench_voxelize(runner& r) {
+    const calc::mesh part = synth::torus(20, 6, 100);
+    for (const double resolution : { 1.0, 0.5, 0.25 }) {
+        calc::mesh mesh = part;
+        mesh.scale(1 / resolution);
+        mesh.set_baseline({ 0, 0, 0 });
+        const auto [x, y, z] = mesh.bounding().box_size;
+        r.run("voxelize/torus/resolution=" + number(resolution), [&] {
+            util::mdarray<int, 3> voxels(x, y, z);
+            return calc::voxelize(mesh, voxels, 1, 1);
+        });
+    }
+}
+
+void bench_occupancy(runner& r) {
+    for (const double resolution : { 1.0, 0.5 }) {
+        const std::string suffix = "/resolution=" + number(resolution);
+        const calc::voxel_shape shape(voxels_of(synth::torus(20, 6, 100), resolution));
+        const std::size_t side = static_cast<std::size_t>(150 / resolution);
+        const std::size_t step = shape.voxels().extent(0);
+
+        // Fill the bottom layer of a plate, the way the stacker would
+        calc::occupancy_grid filled(side, side, side / 2);
+        for (std::size_t x = 0; x + step <= side; x += step) {
+            for (std::size_t y = 0; y + step <= side; y += step) {
+                filled.place(shape, x, y, 0);
+            }
+        }
+
+        r.run("occupancy/collides" + suffix, [&] {
+            std::size_t collisions = 0;
+            for (std::size_t x = 0; x < side; x += 7) {
+                for (std::size_t y = 0; y < side; y += 7) {
+                    collisions += filled.collides(shape, x, y, shape.voxels().extent(2) / 2);
+                }
+            }
+            return collisions;
+        });
+        r.run("occupancy/place" + suffix, [&] {
+            calc::occupancy_grid grid(side, side, side / 2);
+            for (std::size_t x = 0; x + step <= side; x += step) {
+                grid.place(shape, x, 0, 0);
+            }
+            return grid.extent(0);
+        });
+    }
+}
+
+void bench_files(runner& r) {
+    const std::string path = (std::filesystem::temp_directory_path() / "pstack_bench.stl").string();
+    for (const int segments : { 100, 320 }) {
+        const std::string size = std::to_string(2 * segments * segments);
+        const calc::mesh mesh = synth::torus(20, 6, segments);
+        r.run("files/to_stl/triangles=" + size, [&] {
+            files::to_stl(mesh, path);
+            return mesh.triangles().size();
+        });
+        r.run("files/from_stl/triangles=" + size, [&] {
+            return files::from_stl(path).triangles().size();
+        });
+    }
+    std::filesystem::remove(path);
+}
+
+void bench_sinterbox(runner& r) {
+    for (const double spacing : { 6.0, 2.0 }) {
+        const calc::sinterbox_parameters params{
+            .min = { 0, 0, 0 },
+            .max = { 150, 150, 60 },
+            .clearance = 0.8,
+            .thickness = 0.8,
+            .width = 1.1,
+            .spacing = spacing + 0.00013759,
+        };
+        std::vector<geo::triangle> triangles{};
+        r.run("sinterbox/spacing=" + number(spacing), [&] {
+            triangles.clear();
+            calc::append_sinterbox(triangles, params);
+            return triangles.size();
+        });
+    }
+}
+
+void run_stack(runner& r, const std::string& name, const std::vector<std::shared_ptr<calc::part>>& parts, const double resolution, const bool growing, const std::size_t threads) {
+    std::size_t pieces = 0;
+    const calc::stack_parameters params{
+        .parts = { parts.begin(), parts.end() },
+        .set_progress = [](double, double) {},
+        .display_preview = {},
+        .on_success = [&](const calc::stack_result result, std::chrono::system_clock::duration) {
+            pieces = result.pieces.size();
+        },
+        .on_failure = [] {},
+        .on_finish = [] {},
+        .resolution = resolution,
+        .x_min = growing ? 20 : 156, .x_max = 156,
+        .y_min = growing ? 20 : 156, .y_max = 156,
+        .z_min = growing ? 20 : 90, .z_max = 90,
+        .threads = threads,
+        .attempts = 1,
+        .improve_time = {},
+        .preview_interval = {},
+        .voxel_cache = {},
+    };
+    r.run(name, [&] {
+        const std::atomic<bool> running = true;
+        calc::stack(params, running);
+        return pieces;
+    });
+}
+
+// Whole jobs, both with the box already at its largest and with a small box that has to be enlarged.
+// Kept small enough that the whole suite runs in a few minutes on one thread.
+void bench_stack(runner& r, const std::size_t threads) {
+    struct job_size {
+        double resolution;
+        int count; // Of each part
+    };
+    for (const auto [resolution, count] : { job_size{ 1.0, 10 }, job_size{ 1.0, 40 }, job_size{ 0.5, 10 } }) {
+        const std::vector parts = {
+            synth::make_part("torus", synth::torus(20, 6, 64), count),
+            synth::make_part("cube", synth::cube(12), count),
+        };
+        for (const bool growing : { false, true }) {
+            const std::string name = "stack/" + std::string(growing ? "growing" : "fixed") + "/resolution=" + number(resolution) + "/parts=" + std::to_string(2 * count);
+            run_stack(r, name, parts, resolution, growing, threads);
+        }
+    }
+
+    // Every generated shape, at several triangle counts
+    for (const std::size_t triangles : { 500, 5000 }) {
+        const synth::workload_options options{
+            .mix = {
+                { synth::shape::cube, 4 },
+                { synth::shape::torus, 4 },
+                { synth::shape::gear, 4 },
+                { synth::shape::lattice, 2 },
+                { synth::shape::shell, 2 },
+            },
+            .triangles = triangles,
+        };
+        run_stack(r, "stack/mix/triangles=" + std::to_string(triangles) + "/parts=16", synth::make_parts(options), 1, false, threads);
+    }
+}
+
+void print_usage() {
+    std::printf(
+        "Usage: PartStackerBench [options]\n"
+        "\n"
+        "Runs the benchmarks on synthetic parts, printing the median time of each to stderr,\n"
+        "and writing all of the results as JSON.\n"
+        "\n"
+        "Options:\n"
+        "  -f, --filter <text>     Only run benchmarks whose name contains this text\n"
+        "  -s, --samples <count>   Number of timed samples of each benchmark (default 5)\n"
+        "  -t, --threads <count>   Threads used for stacking, where 0 means one per hardware thread (default 0)\n"
+        "  -o, --output <path>     Write the JSON to this file instead of stdout\n"
+        "  -h, --help              Show this message\n");
+}
+
+} // namespace
+
+} // namespace pstack::bench
+
+int main(int argc, char** argv) {
+    using namespace pstack;
+
+    std::string filter{};
+    std::string output{};
+    std::size_t samples = 5;
+    std::size_t threads = 0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const std::string_view value = (i + 1 < argc) ? argv[i + 1] : "";
+        const auto read_number = [&](std::size_t& out) {
+            const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), out);
+            return not value.empty() and error == std::errc{} and end == value.data() + value.size();
+        };
+
+        if (arg == "-h" or arg == "--help") {
+            bench::print_usage();
+            return 0;
+        } else if (arg == "-f" or arg == "--filter" or arg == "-o" or arg == "--output") {
+            if (i + 1 == argc) {
+                std::fprintf(stderr, "Expected %s after %s\n", (arg == "-f" or arg == "--filter") ? "text" : "a path", arg.data());
+                return 2;
+            }
+            std::string& text = (arg == "-f" or arg == "--filter") ? filter : output;
+            text = value;
+        } else if (arg == "-s" or arg == "--samples") {
+            if (not read_number(samples) or samples == 0) {
+                std::fprintf(stderr, "Expected a positive number after %s\n", arg.data());
+                return 2;
+            }
+        } else if (arg == "-t" or arg == "--threads") {
+            if (not read_number(threads)) {
+                std::fprintf(stderr, "Expected a number after %s\n", arg.data());
+                return 2;
+            }
+        } else {
+            bench::print_usage();
+            return 2;
+        }
+        ++i;
+    }
+
+    // Before the benchmarks, so that a path that can't be written doesn't throw away their results
+    std::FILE* file = output.empty() ? stdout : std::fopen(output.c_str(), "w");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Could not open %s\n", output.c_str());
+        return 1;
+    }
+
+    bench::runner r(filter, samples);
+    bench::bench_mesh(r);
+    bench::bench_voxelize(r);
+    bench::bench_occupancy(r);
+    bench::bench_files(r);
+    bench::bench_sinterbox(r);
+    bench::bench_stack(r, threads);
+
+    r.write_json(file, threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads);
+    if (file != stdout) {
+        std::fclose(file);
+    }
+    return 0;
+}
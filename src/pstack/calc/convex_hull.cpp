@@ -0,0 +1,327 @@
+#include "pstack/calc/convex_hull.hpp"
+#include "pstack/calc/indexed_mesh.hpp"
+#include "pstack/util/trace.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace pstack::calc {
+
+namespace {
+
+using vector3 = geo::vector3<double>;
+
+constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+struct hull_face {
+    std::array<std::uint32_t, 3> vertices;
+    std::array<std::uint32_t, 3> neighbours; // Across the edge from `vertices[k]` to `vertices[k + 1]`
+    vector3 normal;                          // Of unit length, pointing out of the hull
+    double offset;                           // Of the plane along `normal`
+    std::uint32_t outside = none;            // The first point above the face that isn't in the hull yet
+    std::uint32_t farthest = none;           // The point above the face farthest from it
+    double farthest_distance = 0;
+    std::uint32_t checked_by = none;         // The last eye to check whether it sees the face
+    bool seen = false;                       // By that eye
+    bool alive = true;
+};
+
+// An edge of a face the eye can see, with a face it can't see on the other side
+struct horizon_edge {
+    std::uint32_t from;
+    std::uint32_t to;
+    std::uint32_t hidden;
+};
+
+class hull_builder {
+public:
+    // Only the vertices matter, each once, which the weld gives
+    explicit hull_builder(const indexed_mesh& mesh) {
+        _points.reserve(mesh.vertices().size());
+        for (const geo::point3<float> v : mesh.vertices()) {
+            _points.push_back({ v.x, v.y, v.z });
+        }
+        _next.assign(_points.size(), none);
+    }
+
+    std::vector<geo::triangle> build() {
+        if (not start()) {
+            return {};
+        }
+
+        // Faces are only ever added, so one pass reaches the faces made along the way too
+        for (std::uint32_t f = 0; f != _faces.size(); ++f) {
+            if (_faces[f].alive and _faces[f].outside != none) {
+                expand(f);
+            }
+        }
+
+        assert(encloses_points());
+
+        std::vector<geo::triangle> out{};
+        for (const hull_face& face : _faces) {
+            if (face.alive) {
+                const auto point = [&](const std::uint32_t i) {
+                    return geo::point3<float>{ static_cast<float>(_points[i].x), static_cast<float>(_points[i].y), static_cast<float>(_points[i].z) };
+                };
+                const geo::vector3<float> normal = { static_cast<float>(face.normal.x), static_cast<float>(face.normal.y), static_cast<float>(face.normal.z) };
+                out.push_back({ normal, point(face.vertices[0]), point(face.vertices[1]), point(face.vertices[2]) });
+            }
+        }
+        return out;
+    }
+
+private:
+    double distance(const hull_face& face, const std::uint32_t point) const {
+        return geo::dot(face.normal, _points[point]) - face.offset;
+    }
+
+    // Whether every point is on or below every face, up to the tolerance points are dropped with
+    bool encloses_points() const {
+        for (const hull_face& face : _faces) {
+            for (std::uint32_t point = 0; face.alive and point != _points.size(); ++point) {
+                if (distance(face, point) > _tolerance) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    std::uint32_t add_face(const std::uint32_t a, const std::uint32_t b, const std::uint32_t c) {
+        const vector3 normal = geo::normalize(geo::cross(_points[b] - _points[a], _points[c] - _points[a]));
+        _faces.push_back({ .vertices = { a, b, c }, .neighbours = { none, none, none }, .normal = normal, .offset = geo::dot(normal, _points[a]) });
+        return static_cast<std::uint32_t>(_faces.size() - 1);
+    }
+
+    // The index of the edge of `face` that starts at vertex `from`
+    int edge_from(const std::uint32_t face, const std::uint32_t from) const {
+        const auto& vertices = _faces[face].vertices;
+        return vertices[0] == from ? 0 : vertices[1] == from ? 1 : 2;
+    }
+
+    // Gives the point to the first of `faces` it lies above, or drops it if it's above none, which puts it inside the hull
+    void assign(const std::uint32_t point, const std::span<const std::uint32_t> faces) {
+        for (const std::uint32_t f : faces) {
+            hull_face& face = _faces[f];
+            const double d = distance(face, point);
+            if (d > _tolerance) {
+                _next[point] = face.outside;
+                face.outside = point;
+                if (d > face.farthest_distance) {
+                    face.farthest = point;
+                    face.farthest_distance = d;
+                }
+                return;
+            }
+        }
+    }
+
+    // Builds a tetrahedron from the points farthest apart, or returns false if they're all on a plane
+    bool start() {
+        if (_points.empty()) {
+            return false;
+        }
+
+        std::array<std::uint32_t, 6> extremes{};
+        double scale = 0;
+        for (std::uint32_t i = 0; i != _points.size(); ++i) {
+            const vector3& p = _points[i];
+            const double coordinates[3] = { p.x, p.y, p.z };
+            for (int axis = 0; axis != 3; ++axis) {
+                const auto along = [&](const std::uint32_t j) {
+                    return axis == 0 ? _points[j].x : axis == 1 ? _points[j].y : _points[j].z;
+                };
+                if (coordinates[axis] < along(extremes[2 * axis])) {
+                    extremes[2 * axis] = i;
+                }
+                if (coordinates[axis] > along(extremes[2 * axis + 1])) {
+                    extremes[2 * axis + 1] = i;
+                }
+                scale = std::max(scale, std::abs(coordinates[axis]));
+            }
+        }
+        // The points come from floats, so points meant to be on one plane are only that close to it. Anything finer
+        // would take rounding for detail, and build slivers of faces that point anywhere.
+        _tolerance = 1e-5 * std::max(scale, 1.0);
+
+        const auto length = [](const vector3& v) {
+            return std::sqrt(geo::dot(v, v));
+        };
+        std::uint32_t a = extremes[0];
+        std::uint32_t b = extremes[1];
+        for (const std::uint32_t i : extremes) {
+            for (const std::uint32_t j : extremes) {
+                if (length(_points[j] - _points[i]) > length(_points[b] - _points[a])) {
+                    a = i;
+                    b = j;
+                }
+            }
+        }
+        if (length(_points[b] - _points[a]) <= _tolerance) {
+            return false;
+        }
+
+        const vector3 line = _points[b] - _points[a];
+        std::uint32_t c = a;
+        double farthest = 0;
+        for (std::uint32_t i = 0; i != _points.size(); ++i) {
+            const double d = length(geo::cross(_points[i] - _points[a], line)) / length(line);
+            if (d > farthest) {
+                farthest = d;
+                c = i;
+            }
+        }
+        if (farthest <= _tolerance) {
+            return false;
+        }
+
+        const vector3 normal = geo::normalize(geo::cross(_points[b] - _points[a], _points[c] - _points[a]));
+        std::uint32_t d = a;
+        farthest = 0;
+        for (std::uint32_t i = 0; i != _points.size(); ++i) {
+            const double height = std::abs(geo::dot(normal, _points[i] - _points[a]));
+            if (height > farthest) {
+                farthest = height;
+                d = i;
+            }
+        }
+        if (farthest <= _tolerance) {
+            return false;
+        }
+
+        // Wound so that the fourth point of the tetrahedron is always behind a face
+        if (geo::dot(normal, _points[d] - _points[a]) > 0) {
+            std::swap(b, c);
+        }
+        const std::array<std::uint32_t, 4> faces = {
+            add_face(a, b, c),
+            add_face(a, d, b),
+            add_face(b, d, c),
+            add_face(c, d, a),
+        };
+        _faces[0].neighbours = { 1, 2, 3 };
+        _faces[1].neighbours = { 3, 2, 0 };
+        _faces[2].neighbours = { 1, 3, 0 };
+        _faces[3].neighbours = { 2, 1, 0 };
+
+        for (std::uint32_t i = 0; i != _points.size(); ++i) {
+            assign(i, faces);
+        }
+        return true;
+    }
+
+    // Adds the farthest point above face `f` to the hull, replacing every face it can see
+    void expand(const std::uint32_t f) {
+        const std::uint32_t eye = _faces[f].farthest;
+
+        // The faces the eye can see form a patch, whose border is the horizon. Walking the patch depth first, always
+        // leaving a face by the edge after the one it was entered by, meets the horizon in order around it.
+        // Faces are marked with the eye that checked them, so that the marks never need clearing.
+        _visible.assign({ f });
+        _horizon.clear();
+        _walk.assign({ { f, 0, 3 } });
+        _faces[f].checked_by = eye;
+        _faces[f].seen = true;
+        while (not _walk.empty()) {
+            walk_step& step = _walk.back();
+            if (step.remaining == 0) {
+                _walk.pop_back();
+                continue;
+            }
+            const std::uint32_t face = step.face;
+            const int k = step.edge;
+            step.edge = (k + 1) % 3;
+            --step.remaining;
+
+            const std::uint32_t from = _faces[face].vertices[k];
+            const std::uint32_t to = _faces[face].vertices[(k + 1) % 3];
+            const std::uint32_t neighbour = _faces[face].neighbours[k];
+            hull_face& other = _faces[neighbour];
+            if (other.checked_by == eye) {
+                if (not other.seen) {
+                    _horizon.push_back({ from, to, neighbour });
+                }
+                continue;
+            }
+            other.checked_by = eye;
+            // Any height at all, unlike the tolerance for points. The cone would fold against a face the eye is only
+            // slightly above, turning it inside out.
+            other.seen = distance(other, eye) > 0;
+            if (other.seen) {
+                _visible.push_back(neighbour);
+                _walk.push_back({ neighbour, (edge_from(neighbour, to) + 1) % 3, 2 });
+            } else {
+                _horizon.push_back({ from, to, neighbour });
+            }
+        }
+
+        _orphans.clear();
+        for (const std::uint32_t v : _visible) {
+            hull_face& face = _faces[v];
+            face.alive = false;
+            for (std::uint32_t point = face.outside; point != none; point = _next[point]) {
+                if (point != eye) {
+                    _orphans.push_back(point);
+                }
+            }
+            face.outside = none;
+        }
+
+        // A cone of faces from the horizon to the eye, each stitched to the face it hides and to its neighbours in the cone
+        _cone.clear();
+        for (const auto [from, to, hidden] : _horizon) {
+            const std::uint32_t face = add_face(from, to, eye);
+            _faces[face].neighbours[0] = hidden;
+            _faces[hidden].neighbours[edge_from(hidden, to)] = face;
+            _cone.push_back(face);
+        }
+        for (std::size_t i = 0; i != _horizon.size(); ++i) {
+            std::size_t next = (i + 1) % _horizon.size();
+            if (_horizon[next].from != _horizon[i].to) {
+                next = std::ranges::find(_horizon, _horizon[i].to, &horizon_edge::from) - _horizon.begin();
+                if (next == _horizon.size()) {
+                    continue;
+                }
+            }
+            _faces[_cone[i]].neighbours[1] = _cone[next];
+            _faces[_cone[next]].neighbours[2] = _cone[i];
+        }
+
+        for (const std::uint32_t point : _orphans) {
+            assign(point, _cone);
+        }
+    }
+
+    struct walk_step {
+        std::uint32_t face;
+        int edge;      // The next edge to cross
+        int remaining; // Edges left to cross
+    };
+
+    std::vector<vector3> _points{};
+    std::vector<std::uint32_t> _next{}; // The next point above the same face
+    std::vector<hull_face> _faces{};
+    double _tolerance = 0;
+
+    // Kept between calls to `expand`, to save allocating them every time
+    std::vector<walk_step> _walk{};
+    std::vector<std::uint32_t> _visible{};
+    std::vector<horizon_edge> _horizon{};
+    std::vector<std::uint32_t> _cone{};
+    std::vector<std::uint32_t> _orphans{};
+};
+
+} // namespace
+
+mesh convex_hull(const mesh& mesh) {
+    const util::trace_scope trace("convex_hull");
+    return hull_builder(indexed_mesh(mesh)).build();
+}
+
+} // namespace pstack::calc
@@ -0,0 +1,14 @@
+#ifndef PSTACK_CALC_CONVEX_HULL_HPP
+#define PSTACK_CALC_CONVEX_HULL_HPP
+
+#include "pstack/calc/mesh.hpp"
+
+namespace pstack::calc {
+
+// The smallest convex polyhedron holding every vertex of `mesh`, as triangles with outward normals, found by quickhull.
+// A mesh too flat to enclose any volume has no hull, and gives an empty mesh.
+mesh convex_hull(const mesh& mesh);
+
+} // namespace pstack::calc
+
+#endif // PSTACK_CALC_CONVEX_HULL_HPP
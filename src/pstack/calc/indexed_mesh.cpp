@@ -0,0 +1,55 @@
+#include "pstack/calc/indexed_mesh.hpp"
+#include "pstack/util/trace.hpp"
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace pstack::calc {
+
+indexed_mesh::indexed_mesh(const mesh& mesh) {
+    const util::trace_scope trace("weld");
+    // Triangles share their corners with their neighbours, so most vertices come several times over. A hash table of the
+    // vertices kept so far, probed linearly, finds the repeats.
+    constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+    const std::size_t corners = 3 * mesh.triangles().size();
+    std::vector<std::uint32_t> kept(std::bit_ceil(std::max<std::size_t>(2 * corners, 2)), none);
+    const std::size_t mask = kept.size() - 1;
+    const int shift = 64 - std::countr_zero(kept.size()); // Multiplying mixes into the high bits, so slots come from those
+    const auto bits = [](const geo::point3<float> v) {
+        return std::array{ std::bit_cast<std::uint32_t>(v.x), std::bit_cast<std::uint32_t>(v.y), std::bit_cast<std::uint32_t>(v.z) };
+    };
+    const auto weld = [&](const geo::point3<float> v) {
+        const auto key = bits(v);
+        std::uint64_t hash = key[0];
+        hash = hash * 0x9e3779b97f4a7c15 ^ key[1];
+        hash = hash * 0x9e3779b97f4a7c15 ^ key[2];
+        hash *= 0x9e3779b97f4a7c15;
+        for (std::size_t slot = hash >> shift; ; slot = (slot + 1) & mask) {
+            if (kept[slot] == none) {
+                kept[slot] = static_cast<std::uint32_t>(_vertices.size());
+                _vertices.push_back(v);
+                return kept[slot];
+            }
+            if (bits(_vertices[kept[slot]]) == key) {
+                return kept[slot];
+            }
+        }
+    };
+
+    _vertices.reserve(corners);
+    _faces.reserve(mesh.triangles().size());
+    for (const geo::triangle& t : mesh.triangles()) {
+        _faces.push_back({ weld(t.v1), weld(t.v2), weld(t.v3) });
+    }
+    _vertices.shrink_to_fit();
+}
+
+geo::vector3<float> face_normal(const geo::point3<float> v1, const geo::point3<float> v2, const geo::point3<float> v3) {
+    const geo::vector3<float> normal = geo::cross(v2 - v1, v3 - v1);
+    if (geo::dot(normal, normal) == 0) {
+        return { 0, 0, 0 };
+    }
+    return geo::normalize(normal);
+}
+
+} // namespace pstack::calc
@@ -0,0 +1,39 @@
+#ifndef PSTACK_CALC_INDEXED_MESH_HPP
+#define PSTACK_CALC_INDEXED_MESH_HPP
+
+#include "pstack/calc/mesh.hpp"
+#include "pstack/geo/point3.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace pstack::calc {
+
+// A mesh whose triangles share their vertices: each vertex is kept once, and each face holds the indices of its three
+// corners. Normals aren't kept either. Transforming and reading it back as triangles is left to `mesh_arrays`.
+class indexed_mesh {
+public:
+    using face = std::array<std::uint32_t, 3>;
+
+    indexed_mesh() = default;
+    // Welds together the corners of `mesh` that are the same to the bit
+    explicit indexed_mesh(const mesh& mesh);
+
+    const std::vector<geo::point3<float>>& vertices() const {
+        return _vertices;
+    }
+    const std::vector<face>& faces() const {
+        return _faces;
+    }
+
+private:
+    std::vector<geo::point3<float>> _vertices{};
+    std::vector<face> _faces{};
+};
+
+// Of unit length, turning counter-clockwise around the corners, or zero for a triangle without area
+geo::vector3<float> face_normal(geo::point3<float> v1, geo::point3<float> v2, geo::point3<float> v3);
+
+} // namespace pstack::calc
+
+#endif // PSTACK_CALC_INDEXED_MESH_HPP
@@ -1,12 +1,46 @@
 #include "pstack/calc/mesh.hpp"
+#include <algorithm>
 #include <limits>
+#include <ranges>
 
 namespace pstack::calc {
 
+namespace {
+
+// The same arithmetic as `mesh::scale` followed by `mesh::rotate`, so that transforming gives the same mesh to the bit
+geo::point3<float> turn(const geo::point3<float> v, const double factor, const geo::matrix3<float>& rotation) {
+    return geo::origin3<float> + (rotation * (factor * v.as_vector()));
+}
+
+// Running bounds, kept apart from `mesh::bounding_t` so that they stay in registers
+struct bounds {
+    float min_x = std::numeric_limits<float>::max();
+    float min_y = std::numeric_limits<float>::max();
+    float min_z = std::numeric_limits<float>::max();
+    float max_x = std::numeric_limits<float>::lowest();
+    float max_y = std::numeric_limits<float>::lowest();
+    float max_z = std::numeric_limits<float>::lowest();
+
+    void include(const geo::point3<float> v) {
+        min_x = std::min(min_x, v.x);
+        min_y = std::min(min_y, v.y);
+        min_z = std::min(min_z, v.z);
+        max_x = std::max(max_x, v.x);
+        max_y = std::max(max_y, v.y);
+        max_z = std::max(max_z, v.z);
+    }
+
+    mesh::bounding_t finish() const {
+        return mesh::bounding_t::between({ min_x, min_y, min_z }, { max_x, max_y, max_z });
+    }
+};
+
+} // namespace
+
 void mesh::add(const mesh& m, const geo::vector3<float> translation) {
-    _triangles.reserve(_triangles.size() + m._triangles.size());
-    for (const auto& t : m._triangles) {
-        auto& triangle = _triangles.emplace_back(t);
+    // Inserting the range grows the storage geometrically, where reserving the exact size would copy everything on each call
+    const auto first = _triangles.insert(_triangles.end(), m._triangles.begin(), m._triangles.end());
+    for (auto& triangle : std::ranges::subrange(first, _triangles.end())) {
         triangle.v1 += translation;
         triangle.v2 += translation;
         triangle.v3 += translation;
@@ -40,35 +74,68 @@ void mesh::rotate(const geo::matrix3<float>& rotation) {
     }
 }
 
-geo::vector3<float> mesh::set_baseline(const geo::point3<float> baseline) {
-    const geo::point3 min = bounding().min;
-    const geo::vector3 offset = baseline - min;
+void mesh::translate(const geo::vector3<float> offset) {
     for (auto& t : _triangles) {
         t.v1 += offset;
         t.v2 += offset;
         t.v3 += offset;
     }
+}
+
+geo::vector3<float> mesh::set_baseline(const geo::point3<float> baseline) {
+    const geo::point3 min = bounding().min;
+    const geo::vector3 offset = baseline - min;
+    translate(offset);
     return offset;
 }
 
-mesh::bounding_t mesh::bounding() const {
-    bounding_t out;
-    out.min = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
-    out.max = { std::numeric_limits<float>::min(), std::numeric_limits<float>::min(), std::numeric_limits<float>::min() };
+mesh::bounding_t mesh::bounding_t::between(const geo::point3<float> min, const geo::point3<float> max) {
+    const geo::vector3<float> size = max - min;
+    return {
+        .min = min,
+        .max = max,
+        .box_size = { geo::ceil(size.x + 2), geo::ceil(size.y + 2), geo::ceil(size.z + 2) },
+    };
+}
 
+mesh::bounding_t mesh::bounding() const {
+    bounds out{};
     for (const auto& triangle : _triangles) {
-        out.min.x = std::min({ out.min.x, triangle.v1.x, triangle.v2.x, triangle.v3.x });
-        out.min.y = std::min({ out.min.y, triangle.v1.y, triangle.v2.y, triangle.v3.y });
-        out.min.z = std::min({ out.min.z, triangle.v1.z, triangle.v2.z, triangle.v3.z });
-
-        out.max.x = std::max({ out.max.x, triangle.v1.x, triangle.v2.x, triangle.v3.x });
-        out.max.y = std::max({ out.max.y, triangle.v1.y, triangle.v2.y, triangle.v3.y });
-        out.max.z = std::max({ out.max.z, triangle.v1.z, triangle.v2.z, triangle.v3.z });
+        out.include(triangle.v1);
+        out.include(triangle.v2);
+        out.include(triangle.v3);
     }
+    return out.finish();
+}
+
+mesh::bounding_t mesh::transform(const double factor, const geo::matrix3<float>& rotation, const geo::vector3<float> translation, mesh& out) const {
+    const std::size_t size = _triangles.size();
+    out._triangles.resize(size);
+    const geo::triangle* const source = _triangles.data();
+    geo::triangle* const target = out._triangles.data();
 
-    const geo::vector3<float> size = out.max - out.min;
-    out.box_size = { geo::ceil(size.x + 2), geo::ceil(size.y + 2), geo::ceil(size.z + 2) };
-    return out;
+    // In blocks that stay in cache, so that the bounds come from the triangles just written, without holding back the
+    // loop that turns them
+    constexpr std::size_t block = 1024;
+    bounds result{};
+    for (std::size_t first = 0; first < size; first += block) {
+        const std::size_t last = std::min(size, first + block);
+        for (std::size_t i = first; i != last; ++i) {
+            const geo::triangle& t = source[i];
+            target[i] = {
+                .normal = rotation * t.normal,
+                .v1 = turn(t.v1, factor, rotation) + translation,
+                .v2 = turn(t.v2, factor, rotation) + translation,
+                .v3 = turn(t.v3, factor, rotation) + translation,
+            };
+        }
+        for (std::size_t i = first; i != last; ++i) {
+            result.include(target[i].v1);
+            result.include(target[i].v2);
+            result.include(target[i].v3);
+        }
+    }
+    return result.finish();
 }
 
 mesh::volume_and_centroid_t mesh::volume_and_centroid() const {
@@ -27,6 +27,7 @@ public:
     void mirror_x();
     void scale(double factor);
     void rotate(const geo::matrix3<float>& rotation);
+    void translate(geo::vector3<float> offset);
     geo::vector3<float> set_baseline(const geo::point3<float> baseline);
 
     void add_sinterbox(const sinterbox_parameters& params) {
@@ -37,10 +38,17 @@ public:
         geo::point3<float> min;
         geo::point3<float> max;
         geo::vector3<int> box_size;
+
+        // From the lowest and highest corners, with the box of voxels that holds them
+        static bounding_t between(geo::point3<float> min, geo::point3<float> max);
     };
 
     bounding_t bounding() const;
 
+    // Writes the mesh, scaled by `factor`, then rotated, then translated, into `out` in one pass, and returns the bounds
+    // of the result. Whatever storage `out` already has is reused.
+    bounding_t transform(double factor, const geo::matrix3<float>& rotation, geo::vector3<float> translation, mesh& out) const;
+
     struct volume_and_centroid_t {
         double volume;
         geo::point3<float> centroid;
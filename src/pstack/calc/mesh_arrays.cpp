@@ -0,0 +1,256 @@
+#include "pstack/calc/mesh_arrays.hpp"
+#include <algorithm>
+#include <array>
+#include <limits>
+
+// Where the compiler can build a function for an instruction set the rest of the program doesn't assume, the kernels are
+// built for AVX2 as well, and picked at runtime if the processor has it
+#if (defined(__GNUC__) or defined(__clang__)) and (defined(__x86_64__) or defined(__i386__))
+#define PSTACK_MESH_ARRAYS_AVX2 1
+#define PSTACK_KERNEL_BODY [[gnu::always_inline]] inline
+#else
+#define PSTACK_KERNEL_BODY inline
+#endif
+
+// Unrolled completely, the loop across lanes of running bounds would leave GCC a chain of scalar minimums for each lane,
+// which it can't turn into vector ones without giving up on how NaNs and signed zeros compare. Kept as a loop, it
+// vectorizes as it stands.
+#if defined(__GNUC__) or defined(__clang__)
+#define PSTACK_ACROSS_LANES _Pragma("GCC unroll 1")
+#else
+#define PSTACK_ACROSS_LANES
+#endif
+
+namespace pstack::calc {
+
+namespace {
+
+// As wide as the widest vector register holds floats, so that lanes of running bounds become one register
+constexpr std::size_t lanes = 8;
+
+// Each job is a range of the coordinate columns of `mesh_arrays`
+struct transform_job {
+    std::array<const float*, 3> in;
+    std::array<float*, 3> out;
+    std::size_t size;
+    float factor;
+    geo::matrix3<float> rotation;
+    geo::vector3<float> translation;
+    std::array<float, 3> min;
+    std::array<float, 3> max;
+};
+
+struct bounding_job {
+    std::array<const float*, 3> columns;
+    std::size_t size;
+    std::array<float, 3> min;
+    std::array<float, 3> max;
+};
+
+struct translate_job {
+    std::array<float*, 3> columns;
+    std::size_t size;
+    geo::vector3<float> offset;
+};
+
+// The bodies below are compiled once for every instruction set, inlined into each entry point. They keep to the order of
+// operations of `geo`, so that every instruction set gives the same floats as `mesh`.
+
+PSTACK_KERNEL_BODY void turn_points(const float* in_x, const float* in_y, const float* in_z, float* out_x, float* out_y, float* out_z,
+                                    const std::size_t size, const float factor, const geo::matrix3<float> r, const geo::vector3<float> t)
+{
+    for (std::size_t i = 0; i != size; ++i) {
+        const float x = factor * in_x[i];
+        const float y = factor * in_y[i];
+        const float z = factor * in_z[i];
+        out_x[i] = (0.0f + ((r.xx * x) + (r.xy * y) + (r.xz * z))) + t.x;
+        out_y[i] = (0.0f + ((r.yx * x) + (r.yy * y) + (r.yz * z))) + t.y;
+        out_z[i] = (0.0f + ((r.zx * x) + (r.zy * y) + (r.zz * z))) + t.z;
+    }
+}
+
+PSTACK_KERNEL_BODY void bound_column(const float* values, const std::size_t size, float& min, float& max) {
+    std::array<float, lanes> low;
+    std::array<float, lanes> high;
+    low.fill(min);
+    high.fill(max);
+    std::size_t i = 0;
+    for (; i + lanes <= size; i += lanes) {
+        PSTACK_ACROSS_LANES
+        for (std::size_t lane = 0; lane != lanes; ++lane) {
+            const float value = values[i + lane];
+            const float lowest_yet = low[lane];
+            const float highest_yet = high[lane];
+            low[lane] = std::min(lowest_yet, value);
+            high[lane] = std::max(highest_yet, value);
+        }
+    }
+    for (; i != size; ++i) {
+        low[0] = std::min(low[0], values[i]);
+        high[0] = std::max(high[0], values[i]);
+    }
+    for (std::size_t lane = 0; lane != lanes; ++lane) {
+        min = std::min(min, low[lane]);
+        max = std::max(max, high[lane]);
+    }
+}
+
+PSTACK_KERNEL_BODY void transform_body(transform_job& job) {
+    // In blocks, each turned into buffers of its own, then bounded and copied out. A mesh may be turned in place, so the
+    // compiler can't tell the columns read from those written, and checking at runtime is more than it's willing to do.
+    constexpr std::size_t block = 1024;
+    alignas(32) float x[block];
+    alignas(32) float y[block];
+    alignas(32) float z[block];
+    for (std::size_t first = 0; first < job.size; first += block) {
+        const std::size_t size = std::min(block, job.size - first);
+        turn_points(job.in[0] + first, job.in[1] + first, job.in[2] + first, x, y, z, size, job.factor, job.rotation, job.translation);
+        bound_column(x, size, job.min[0], job.max[0]);
+        bound_column(y, size, job.min[1], job.max[1]);
+        bound_column(z, size, job.min[2], job.max[2]);
+        std::copy_n(x, size, job.out[0] + first);
+        std::copy_n(y, size, job.out[1] + first);
+        std::copy_n(z, size, job.out[2] + first);
+    }
+}
+
+PSTACK_KERNEL_BODY void bounding_body(bounding_job& job) {
+    for (int axis = 0; axis != 3; ++axis) {
+        bound_column(job.columns[axis], job.size, job.min[axis], job.max[axis]);
+    }
+}
+
+PSTACK_KERNEL_BODY void translate_body(translate_job& job) {
+    const float offsets[3] = { job.offset.x, job.offset.y, job.offset.z };
+    for (int axis = 0; axis != 3; ++axis) {
+        float* const values = job.columns[axis];
+        const float offset = offsets[axis];
+        for (std::size_t i = 0; i != job.size; ++i) {
+            values[i] += offset;
+        }
+    }
+}
+
+struct kernel_set {
+    void (*transform)(transform_job&);
+    void (*bounding)(bounding_job&);
+    void (*translate)(translate_job&);
+};
+
+void transform_baseline(transform_job& job) {
+    transform_body(job);
+}
+void bounding_baseline(bounding_job& job) {
+    bounding_body(job);
+}
+void translate_baseline(translate_job& job) {
+    translate_body(job);
+}
+
+#ifdef PSTACK_MESH_ARRAYS_AVX2
+[[gnu::target("avx2")]] void transform_avx2(transform_job& job) {
+    transform_body(job);
+}
+[[gnu::target("avx2")]] void bounding_avx2(bounding_job& job) {
+    bounding_body(job);
+}
+[[gnu::target("avx2")]] void translate_avx2(translate_job& job) {
+    translate_body(job);
+}
+#endif
+
+// Chosen once, by what the processor running the program supports.
+// Only AVX2 is asked for, and not FMA, since fusing multiplies and adds would round differently from `mesh`.
+const kernel_set& kernels() {
+    static const kernel_set chosen = [] {
+#ifdef PSTACK_MESH_ARRAYS_AVX2
+        if (__builtin_cpu_supports("avx2")) {
+            return kernel_set{ transform_avx2, bounding_avx2, translate_avx2 };
+        }
+#endif
+        return kernel_set{ transform_baseline, bounding_baseline, translate_baseline };
+    }();
+    return chosen;
+}
+
+constexpr float lowest = std::numeric_limits<float>::lowest();
+constexpr float highest = std::numeric_limits<float>::max();
+
+} // namespace
+
+mesh_arrays::mesh_arrays(const indexed_mesh& mesh)
+    : _vertex_count(mesh.vertices().size())
+    , _columns(3 * _vertex_count)
+    , _faces(std::make_shared<const std::vector<indexed_mesh::face>>(mesh.faces()))
+{
+    for (std::size_t i = 0; i != _vertex_count; ++i) {
+        column(0)[i] = mesh.vertices()[i].x;
+        column(1)[i] = mesh.vertices()[i].y;
+        column(2)[i] = mesh.vertices()[i].z;
+    }
+}
+
+std::array<geo::point3<float>, 3> mesh_arrays::corners(const std::size_t index) const {
+    const auto vertex = [&](const std::uint32_t i) {
+        return geo::point3<float>{ column(0)[i], column(1)[i], column(2)[i] };
+    };
+    const auto [a, b, c] = (*_faces)[index];
+    return { vertex(a), vertex(b), vertex(c) };
+}
+
+geo::triangle mesh_arrays::triangle(const std::size_t index) const {
+    const auto [v1, v2, v3] = corners(index);
+    return { face_normal(v1, v2, v3), v1, v2, v3 };
+}
+
+std::vector<geo::triangle> mesh_arrays::triangles() const {
+    std::vector<geo::triangle> out(size());
+    for (std::size_t i = 0; i != out.size(); ++i) {
+        out[i] = triangle(i);
+    }
+    return out;
+}
+
+void mesh_arrays::translate(const geo::vector3<float> offset) {
+    translate_job job{ .columns = { column(0), column(1), column(2) }, .size = _vertex_count, .offset = offset };
+    kernels().translate(job);
+}
+
+geo::vector3<float> mesh_arrays::set_baseline(const geo::point3<float> baseline) {
+    const geo::vector3<float> offset = baseline - bounding().min;
+    translate(offset);
+    return offset;
+}
+
+mesh::bounding_t mesh_arrays::bounding() const {
+    bounding_job job{
+        .columns = { column(0), column(1), column(2) },
+        .size = _vertex_count,
+        .min = { highest, highest, highest },
+        .max = { lowest, lowest, lowest },
+    };
+    kernels().bounding(job);
+    return mesh::bounding_t::between({ job.min[0], job.min[1], job.min[2] }, { job.max[0], job.max[1], job.max[2] });
+}
+
+mesh::bounding_t mesh_arrays::transform(const double factor, const geo::matrix3<float>& rotation, const geo::vector3<float> translation, mesh_arrays& out) const {
+    if (&out != this) {
+        out._vertex_count = _vertex_count;
+        out._columns.resize(_columns.size());
+        out._faces = _faces;
+    }
+    transform_job job{
+        .in = { column(0), column(1), column(2) },
+        .out = { out.column(0), out.column(1), out.column(2) },
+        .size = _vertex_count,
+        .factor = static_cast<float>(factor),
+        .rotation = rotation,
+        .translation = translation,
+        .min = { highest, highest, highest },
+        .max = { lowest, lowest, lowest },
+    };
+    kernels().transform(job);
+    return mesh::bounding_t::between({ job.min[0], job.min[1], job.min[2] }, { job.max[0], job.max[1], job.max[2] });
+}
+
+} // namespace pstack::calc
@@ -0,0 +1,55 @@
+#ifndef PSTACK_CALC_MESH_ARRAYS_HPP
+#define PSTACK_CALC_MESH_ARRAYS_HPP
+
+#include "pstack/calc/indexed_mesh.hpp"
+#include "pstack/calc/mesh.hpp"
+#include "pstack/geo/matrix3.hpp"
+#include "pstack/geo/triangle.hpp"
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace pstack::calc {
+
+// The vertices of an indexed mesh stored as a structure of arrays, one for each coordinate, so that transforms and bounds
+// run over contiguous floats, several at a time. The faces are shared with every mesh transformed from this one. Meant
+// for the meshes the stacker turns over and over; `triangles` gives them back in the layout everything else uses.
+class mesh_arrays {
+public:
+    mesh_arrays() = default;
+    explicit mesh_arrays(const indexed_mesh& mesh);
+
+    // The number of triangles
+    std::size_t size() const {
+        return _faces ? _faces->size() : 0;
+    }
+
+    std::array<geo::point3<float>, 3> corners(std::size_t index) const;
+    geo::triangle triangle(std::size_t index) const;
+    std::vector<geo::triangle> triangles() const;
+
+    void translate(geo::vector3<float> offset);
+    geo::vector3<float> set_baseline(geo::point3<float> baseline);
+
+    mesh::bounding_t bounding() const;
+
+    // Gives the same vertices as `mesh::transform`, to the bit
+    mesh::bounding_t transform(double factor, const geo::matrix3<float>& rotation, geo::vector3<float> translation, mesh_arrays& out) const;
+
+private:
+    const float* column(const int axis) const {
+        return _columns.data() + axis * _vertex_count;
+    }
+    float* column(const int axis) {
+        return _columns.data() + axis * _vertex_count;
+    }
+
+    std::size_t _vertex_count = 0;
+    std::vector<float> _columns{};
+    std::shared_ptr<const std::vector<indexed_mesh::face>> _faces{};
+};
+
+} // namespace pstack::calc
+
+#endif // PSTACK_CALC_MESH_ARRAYS_HPP
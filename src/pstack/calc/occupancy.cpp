@@ -0,0 +1,140 @@
+#include "pstack/calc/occupancy.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace pstack::calc {
+
+namespace {
+
+constexpr std::size_t word_bits = util::bit_grid::word_bits;
+
+// Finds the occupied voxel of row (x, y) closest above `z`, or the lowest one if there is none
+std::size_t probe_height(const util::bit_grid& voxels, const std::size_t x, const std::size_t y, const std::size_t z, const std::size_t min) {
+    for (std::size_t k = z; k < voxels.extent(2); k += word_bits) {
+        if (const auto bits = voxels.load(x, y, k); bits != 0) {
+            return k + std::countr_zero(bits);
+        }
+    }
+    return min;
+}
+
+} // namespace
+
+voxel_shape::voxel_shape(util::bit_grid voxels)
+    : _voxels(std::move(voxels))
+    , _rows(_voxels.extent(0), _voxels.extent(1))
+{
+    for (std::size_t i = 0; i < _voxels.extent(0); ++i) {
+        for (std::size_t j = 0; j < _voxels.extent(1); ++j) {
+            const auto row = _voxels.row(i, j);
+            const auto first = std::ranges::find_if(row, [](auto word) { return word != 0; });
+            if (first == row.end()) {
+                _rows[i, j] = { 0, 0 };
+                continue;
+            }
+            const auto last = std::ranges::find_if(row.rbegin(), row.rend(), [](auto word) { return word != 0; });
+            const std::size_t first_index = first - row.begin();
+            const std::size_t last_index = row.rend() - last - 1;
+            _rows[i, j] = {
+                .min = first_index * word_bits + std::countr_zero(*first),
+                .max = last_index * word_bits + (word_bits - std::countl_zero(*last)),
+            };
+        }
+    }
+
+    // Probe the middle of the part and of each quarter of its footprint, where other parts are most likely to be in the way
+    const std::size_t ex = _voxels.extent(0);
+    const std::size_t ey = _voxels.extent(1);
+    const std::pair<std::size_t, std::size_t> probe_rows[] = {
+        { ex / 2, ey / 2 },
+        { ex / 4, ey / 4 }, { (3 * ex) / 4, ey / 4 },
+        { ex / 4, (3 * ey) / 4 }, { (3 * ex) / 4, (3 * ey) / 4 },
+    };
+    for (const auto& [i, j] : probe_rows) {
+        if (i >= ex or j >= ey) {
+            continue;
+        }
+        const auto [min, max] = _rows[i, j];
+        if (min == max) {
+            continue;
+        }
+        const geo::point3<std::size_t> probe = { i, j, probe_height(_voxels, i, j, (min + max) / 2, min) };
+        if (std::ranges::find_if(_probes, [&](const auto& p) { return p.x == probe.x and p.y == probe.y and p.z == probe.z; }) == _probes.end()) {
+            _probes.push_back(probe);
+        }
+    }
+}
+
+std::size_t voxel_shape::memory() const {
+    return _voxels.memory() + _rows.size() * sizeof(row_range) + _probes.size() * sizeof(_probes[0]);
+}
+
+occupancy_grid::occupancy_grid(const std::size_t x, const std::size_t y, const std::size_t z)
+    : _space(x, y, z)
+    , _heights(x, y)
+{}
+
+bool occupancy_grid::collides(const voxel_shape& shape, const std::size_t x, const std::size_t y, const std::size_t z, collision_counters& counters) const {
+    if (x >= extent(0) or y >= extent(1) or z >= extent(2)) {
+        return false;
+    }
+
+    // Reject quickly if one of the probe voxels is occupied
+    for (const auto& probe : shape._probes) {
+        if (x + probe.x < extent(0) and y + probe.y < extent(1) and z + probe.z < extent(2)) {
+            ++counters.voxels_tested;
+            if (_space.test(x + probe.x, y + probe.y, z + probe.z)) {
+                ++counters.probe_rejections;
+                return true;
+            }
+        }
+    }
+
+    const std::size_t max_i = std::min(x + shape._voxels.extent(0), extent(0));
+    const std::size_t max_j = std::min(y + shape._voxels.extent(1), extent(1));
+    for (std::size_t i = x; i < max_i; ++i) {
+        for (std::size_t j = y; j < max_j; ++j) {
+            const auto [min, max] = shape._rows[i - x, j - y];
+            const std::size_t height = _heights[i, j];
+            if (min == max or z + min >= height) { // Nothing has been placed within reach of this row
+                continue;
+            }
+            const auto row = shape._voxels.row(i - x, j - y);
+            const std::size_t max_w = (max + word_bits - 1) / word_bits;
+            for (std::size_t w = min / word_bits; w < max_w and z + w * word_bits < height; ++w) {
+                if (row[w] == 0) {
+                    continue;
+                }
+                counters.voxels_tested += word_bits;
+                if ((row[w] & _space.load(i, j, z + w * word_bits)) != 0) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void occupancy_grid::place(const voxel_shape& shape, const std::size_t x, const std::size_t y, const std::size_t z) {
+    const std::size_t max_i = std::min(x + shape._voxels.extent(0), extent(0));
+    const std::size_t max_j = std::min(y + shape._voxels.extent(1), extent(1));
+    for (std::size_t i = x; i < max_i; ++i) {
+        for (std::size_t j = y; j < max_j; ++j) {
+            const auto [min, max] = shape._rows[i - x, j - y];
+            if (min == max) {
+                continue;
+            }
+            const auto row = shape._voxels.row(i - x, j - y);
+            for (std::size_t w = min / word_bits; w < (max + word_bits - 1) / word_bits; ++w) {
+                _space.store_or(i, j, z + w * word_bits, row[w]);
+            }
+            _heights[i, j] = std::max(_heights[i, j], std::min(z + max, extent(2)));
+        }
+    }
+}
+
+std::size_t occupancy_grid::memory() const {
+    return _space.memory() + _heights.size() * sizeof(std::size_t);
+}
+
+} // namespace pstack::calc
@@ -0,0 +1,77 @@
+#ifndef PSTACK_CALC_OCCUPANCY_HPP
+#define PSTACK_CALC_OCCUPANCY_HPP
+
+#include "pstack/geo/point3.hpp"
+#include "pstack/util/bit_grid.hpp"
+#include "pstack/util/mdarray.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace pstack::calc {
+
+// The voxels of one orientation of a part, with the occupied z-range of each row and a few probe voxels
+class voxel_shape {
+public:
+    voxel_shape() = default;
+    voxel_shape(util::bit_grid voxels);
+
+    const util::bit_grid& voxels() const {
+        return _voxels;
+    }
+
+    // In bytes
+    std::size_t memory() const;
+
+private:
+    friend class occupancy_grid;
+
+    struct row_range {
+        std::size_t min; // Lowest occupied z
+        std::size_t max; // One past the highest occupied z, or equal to `min` for an empty row
+    };
+
+    util::bit_grid _voxels{};
+    util::mdarray<row_range, 2> _rows{};
+    std::vector<geo::point3<std::size_t>> _probes{};
+};
+
+// The work done by `occupancy_grid::collides`, added up over many calls
+struct collision_counters {
+    std::uint64_t voxels_tested = 0;
+    std::uint64_t probe_rejections = 0; // Collisions found by a probe voxel, without scanning the rows
+};
+
+// The occupied space of a stack, with a heightmap of each (x, y) column
+class occupancy_grid {
+public:
+    occupancy_grid() = default;
+    occupancy_grid(std::size_t x, std::size_t y, std::size_t z);
+
+    std::size_t extent(const std::size_t dimension) const {
+        return _space.extent(dimension);
+    }
+
+    bool occupied(const std::size_t x, const std::size_t y, const std::size_t z) const {
+        return _space.test(x, y, z);
+    }
+
+    // Voxels of the shape that fall outside the grid never collide
+    bool collides(const voxel_shape& shape, std::size_t x, std::size_t y, std::size_t z, collision_counters& counters) const;
+    bool collides(const voxel_shape& shape, const std::size_t x, const std::size_t y, const std::size_t z) const {
+        collision_counters counters{};
+        return collides(shape, x, y, z, counters);
+    }
+
+    void place(const voxel_shape& shape, std::size_t x, std::size_t y, std::size_t z);
+
+    // In bytes
+    std::size_t memory() const;
+
+private:
+    util::bit_grid _space{};
+    util::mdarray<std::size_t, 2> _heights{}; // One past the highest occupied z in each column
+};
+
+} // namespace pstack::calc
+
+#endif // PSTACK_CALC_OCCUPANCY_HPP
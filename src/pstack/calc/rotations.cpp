@@ -1,16 +1,26 @@
+#include "pstack/calc/convex_hull.hpp"
 #include "pstack/calc/rotations.hpp"
+#include "pstack/util/trace.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
 #include <random>
+#include <ranges>
+#include <tuple>
+#include <vector>
 
 namespace pstack::calc {
 
 const std::array<geo::matrix3<float>, 32> arbitrary_rotations = [] {
     std::array<geo::matrix3<float>, 32> out;
     out[0] = geo::eye3<float>;
-    out[1] = geo::rot3<float>({ 1, 1, 1 }, 120);
-    out[2] = geo::rot3<float>({ 1, 1, 1 }, 240);
-    out[3] = geo::rot3<float>({ 1, 0, 0 }, 180);
-    out[4] = geo::rot3<float>({ 0, 1, 0 }, 180);
-    out[5] = geo::rot3<float>({ 0, 0, 1 }, 180);
+    out[1] = cube_rotation({ 1, 1, 1 }, 120);
+    out[2] = cube_rotation({ 1, 1, 1 }, 240);
+    out[3] = cube_rotation({ 1, 0, 0 }, 180);
+    out[4] = cube_rotation({ 0, 1, 0 }, 180);
+    out[5] = cube_rotation({ 0, 0, 1 }, 180);
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_real_distribution<float> dis(0, 2 * geo::pi);
@@ -20,4 +30,223 @@ const std::array<geo::matrix3<float>, 32> arbitrary_rotations = [] {
     return out;
 }();
 
+namespace {
+
+using vector3 = geo::vector3<double>;
+
+struct point2 {
+    double x;
+    double y;
+};
+
+double dot(const point2 a, const point2 b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+point2 operator-(const point2 a, const point2 b) {
+    return { a.x - b.x, a.y - b.y };
+}
+
+// Positive if `o`, `a`, `b` turn counter-clockwise
+double turn(const point2 o, const point2 a, const point2 b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+// Counter-clockwise and without collinear points, by Andrew's monotone chain
+std::vector<point2> convex_hull_2d(std::vector<point2> points) {
+    // Points inside the polygon of the extremes in eight directions can't be on the hull, and dropping them first
+    // leaves little to sort (Akl and Toussaint)
+    if (not points.empty()) {
+        constexpr point2 directions[8] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+        std::array<point2, 8> extremes{};
+        extremes.fill(points.front());
+        for (const point2 p : points) {
+            for (int k = 0; k != 8; ++k) {
+                if (dot(directions[k], p) > dot(directions[k], extremes[k])) {
+                    extremes[k] = p;
+                }
+            }
+        }
+        const auto inside = [&](const point2 p) {
+            bool bounded = false;
+            for (int k = 0; k != 8; ++k) {
+                const point2 a = extremes[k];
+                const point2 b = extremes[(k + 1) % 8];
+                if (a.x == b.x and a.y == b.y) {
+                    continue;
+                }
+                if (turn(a, b, p) <= 0) {
+                    return false;
+                }
+                bounded = true;
+            }
+            return bounded;
+        };
+        std::erase_if(points, inside);
+    }
+    std::ranges::sort(points, [](const point2 a, const point2 b) {
+        return a.x < b.x or (a.x == b.x and a.y < b.y);
+    });
+    if (points.size() < 3) {
+        return points;
+    }
+    std::vector<point2> out(2 * points.size());
+    std::size_t k = 0;
+    for (std::size_t i = 0; i != points.size(); ++i) {
+        while (k >= 2 and turn(out[k - 2], out[k - 1], points[i]) <= 0) {
+            --k;
+        }
+        out[k++] = points[i];
+    }
+    for (std::size_t i = points.size() - 1, lower = k + 1; i > 0; --i) {
+        while (k >= lower and turn(out[k - 2], out[k - 1], points[i - 1]) <= 0) {
+            --k;
+        }
+        out[k++] = points[i - 1];
+    }
+    out.resize(k - 1);
+    return out;
+}
+
+struct rectangle {
+    double area;
+    point2 direction; // Of unit length, along one side
+};
+
+// The smallest rectangle around a convex polygon, which has a side along one of its edges, found by rotating calipers
+rectangle min_area_rectangle(const std::vector<point2>& polygon) {
+    const std::size_t n = polygon.size();
+    if (n < 3) {
+        return { 0, { 1, 0 } };
+    }
+    rectangle best{ std::numeric_limits<double>::max(), { 1, 0 } };
+    std::size_t ahead = 1;    // Farthest along the edge
+    std::size_t across = 1;   // Farthest from the edge
+    std::size_t behind = 0;   // Farthest back along the edge
+    for (std::size_t i = 0; i != n; ++i) {
+        const point2 edge = polygon[(i + 1) % n] - polygon[i];
+        const double length = std::sqrt(dot(edge, edge));
+        const point2 along = { edge.x / length, edge.y / length };
+        const point2 inward = { -along.y, along.x };
+        while (dot(along, polygon[(ahead + 1) % n]) > dot(along, polygon[ahead])) {
+            ahead = (ahead + 1) % n;
+        }
+        while (dot(inward, polygon[(across + 1) % n]) > dot(inward, polygon[across])) {
+            across = (across + 1) % n;
+        }
+        if (i == 0) {
+            behind = across;
+        }
+        while (dot(along, polygon[(behind + 1) % n]) < dot(along, polygon[behind])) {
+            behind = (behind + 1) % n;
+        }
+        const double area = dot(along, polygon[ahead] - polygon[behind]) * dot(inward, polygon[across] - polygon[i]);
+        if (area < best.area) {
+            best = { area, along };
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+geo::matrix3<float> min_box_rotation(const mesh& part_mesh) {
+    const util::trace_scope trace("min_box_rotation");
+    const mesh hull = convex_hull(part_mesh);
+    if (hull.triangles().empty()) {
+        return geo::eye3<float>;
+    }
+
+    std::vector<geo::point3<float>> vertices{};
+    vertices.reserve(3 * hull.triangles().size());
+    for (const geo::triangle& t : hull.triangles()) {
+        vertices.insert(vertices.end(), { t.v1, t.v2, t.v3 });
+    }
+    const auto as_tuple = [](const geo::point3<float>& v) {
+        return std::tuple(v.x, v.y, v.z);
+    };
+    std::ranges::sort(vertices, {}, as_tuple);
+    const auto duplicates = std::ranges::unique(vertices, {}, as_tuple);
+    std::vector<vector3> points{};
+    points.reserve(duplicates.begin() - vertices.begin());
+    for (const geo::point3<float> v : std::ranges::subrange(vertices.begin(), duplicates.begin())) {
+        points.push_back({ v.x, v.y, v.z });
+    }
+
+    const auto extent = [&](const vector3 axis) {
+        const auto [min, max] = std::ranges::minmax(points | std::views::transform([&](const vector3& p) {
+            return geo::dot(axis, p);
+        }));
+        return max - min;
+    };
+    const double unturned_volume = extent(geo::unit_x<double>) * extent(geo::unit_y<double>) * extent(geo::unit_z<double>);
+
+    // The box rests on a face of the hull. Coplanar triangles of the hull add up to one face, and the largest faces
+    // are tried first, since the smallest box almost always rests on one of them.
+    // Thin triangles of the hull have noisy normals, so the faces gather triangles by coarsely rounded normals, and take
+    // the average normal weighted by area.
+    struct face {
+        std::tuple<long, long, long> key; // The normal, rounded
+        vector3 normal;                   // Twice the area in length, until the faces are gathered
+        double area;
+    };
+    std::vector<face> faces{};
+    for (const geo::triangle& t : hull.triangles()) {
+        const vector3 a = { t.v1.x, t.v1.y, t.v1.z };
+        const vector3 b = { t.v2.x, t.v2.y, t.v2.z };
+        const vector3 c = { t.v3.x, t.v3.y, t.v3.z };
+        const vector3 normal = geo::cross(b - a, c - a);
+        const double area = std::sqrt(geo::dot(normal, normal)) / 2;
+        if (area == 0) {
+            continue;
+        }
+        const vector3 unit = geo::normalize(normal);
+        faces.push_back({ std::tuple(std::lround(unit.x * 1e2), std::lround(unit.y * 1e2), std::lround(unit.z * 1e2)), normal, area });
+    }
+    std::ranges::sort(faces, {}, &face::key);
+    std::vector<face> candidates{};
+    for (const face& f : faces) {
+        if (not candidates.empty() and candidates.back().key == f.key) {
+            candidates.back().normal = candidates.back().normal + f.normal;
+            candidates.back().area += f.area;
+        } else {
+            candidates.push_back(f);
+        }
+    }
+    // Each face projects every point of the hull, so hulls with many points try fewer faces
+    constexpr std::size_t projection_budget = 1 << 20;
+    const std::size_t max_candidates = std::clamp<std::size_t>(projection_budget / points.size(), 8, 128);
+    const auto last = candidates.begin() + std::min(candidates.size(), max_candidates);
+    std::ranges::partial_sort(candidates, last, std::greater{}, &face::area);
+    candidates.erase(last, candidates.end());
+
+    double best_volume = unturned_volume;
+    geo::matrix3<float> best = geo::eye3<float>;
+    std::vector<point2> projected(points.size());
+    for (const auto& [key, sum, area] : candidates) {
+        const vector3 normal = geo::normalize(sum);
+        const vector3 helper = std::abs(normal.x) < 0.5 ? geo::unit_x<double> : geo::unit_y<double>;
+        const vector3 u = geo::normalize(geo::cross(normal, helper));
+        const vector3 v = geo::cross(normal, u);
+        for (std::size_t i = 0; i != points.size(); ++i) {
+            projected[i] = { geo::dot(u, points[i]), geo::dot(v, points[i]) };
+        }
+        const rectangle footprint = min_area_rectangle(convex_hull_2d(projected));
+        const double volume = footprint.area * extent(normal);
+        if (volume < best_volume) {
+            best_volume = volume;
+            // Resting on the face means its normal points down
+            const vector3 x = footprint.direction.x * u + footprint.direction.y * v;
+            const vector3 z = -normal;
+            const vector3 y = geo::cross(z, x);
+            best = { static_cast<float>(x.x), static_cast<float>(x.y), static_cast<float>(x.z),
+                     static_cast<float>(y.x), static_cast<float>(y.y), static_cast<float>(y.z),
+                     static_cast<float>(z.x), static_cast<float>(z.y), static_cast<float>(z.z) };
+        }
+    }
+
+    // Parts that are already square to the axes stay as they are
+    return best_volume < 0.99 * unturned_volume ? best : geo::eye3<float>;
+}
+
 } // namespace pstack::calc
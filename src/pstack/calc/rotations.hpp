@@ -1,41 +1,54 @@
 #ifndef PSTACK_CALC_ROTATIONS_HPP
 #define PSTACK_CALC_ROTATIONS_HPP
 
+#include "pstack/calc/mesh.hpp"
 #include "pstack/geo/matrix3.hpp"
 #include <array>
 #include <span>
 
 namespace pstack::calc {
 
+// A rotation of a cube onto itself, `degrees` about `axis`. Every entry is exactly 0, 1, or -1, so rotating by it only
+// swaps and negates coordinates, without rounding.
+constexpr geo::matrix3<float> cube_rotation(const geo::vector3<double>& axis, const int degrees) {
+    const auto exact = [](const double entry) {
+        return entry > 0.5 ? 1.0f : entry < -0.5 ? -1.0f : 0.0f;
+    };
+    const auto m = geo::rot3<double>(axis, degrees * geo::pi / 180);
+    return { exact(m.xx), exact(m.xy), exact(m.xz),
+             exact(m.yx), exact(m.yy), exact(m.yz),
+             exact(m.zx), exact(m.zy), exact(m.zz) };
+}
+
 inline constexpr std::array no_rotations = {
     geo::eye3<float>,
 };
 
 inline constexpr std::array cubic_rotations = {
     geo::eye3<float>,
-    geo::rot3<float>({ 1, 0, 0 }, 90),
-    geo::rot3<float>({ 1, 0, 0 }, 180),
-    geo::rot3<float>({ 1, 0, 0 }, 270),
-    geo::rot3<float>({ 0, 1, 0 }, 90),
-    geo::rot3<float>({ 0, 1, 0 }, 180),
-    geo::rot3<float>({ 0, 1, 0 }, 270),
-    geo::rot3<float>({ 0, 0, 1 }, 90),
-    geo::rot3<float>({ 0, 0, 1 }, 180),
-    geo::rot3<float>({ 0, 0, 1 }, 270),
-    geo::rot3<float>({ 1, 1, 0 }, 180),
-    geo::rot3<float>({ 1, -1, 0 }, 180),
-    geo::rot3<float>({ 0, 1, 1 }, 180),
-    geo::rot3<float>({ 0, -1, 1 }, 180),
-    geo::rot3<float>({ 1, 0, 1 }, 180),
-    geo::rot3<float>({ 1, 0, -1 }, 180),
-    geo::rot3<float>({ 1, 1, 1 }, 120),
-    geo::rot3<float>({ 1, 1, 1 }, 240),
-    geo::rot3<float>({ -1, 1, 1 }, 120),
-    geo::rot3<float>({ -1, 1, 1 }, 240),
-    geo::rot3<float>({ 1, -1, 1 }, 120),
-    geo::rot3<float>({ 1, -1, 1 }, 240),
-    geo::rot3<float>({ 1, 1, -1 }, 120),
-    geo::rot3<float>({ 1, 1, -1 }, 240),
+    cube_rotation({ 1, 0, 0 }, 90),
+    cube_rotation({ 1, 0, 0 }, 180),
+    cube_rotation({ 1, 0, 0 }, 270),
+    cube_rotation({ 0, 1, 0 }, 90),
+    cube_rotation({ 0, 1, 0 }, 180),
+    cube_rotation({ 0, 1, 0 }, 270),
+    cube_rotation({ 0, 0, 1 }, 90),
+    cube_rotation({ 0, 0, 1 }, 180),
+    cube_rotation({ 0, 0, 1 }, 270),
+    cube_rotation({ 1, 1, 0 }, 180),
+    cube_rotation({ 1, -1, 0 }, 180),
+    cube_rotation({ 0, 1, 1 }, 180),
+    cube_rotation({ 0, -1, 1 }, 180),
+    cube_rotation({ 1, 0, 1 }, 180),
+    cube_rotation({ 1, 0, -1 }, 180),
+    cube_rotation({ 1, 1, 1 }, 120),
+    cube_rotation({ 1, 1, 1 }, 240),
+    cube_rotation({ -1, 1, 1 }, 120),
+    cube_rotation({ -1, 1, 1 }, 240),
+    cube_rotation({ 1, -1, 1 }, 120),
+    cube_rotation({ 1, -1, 1 }, 240),
+    cube_rotation({ 1, 1, -1 }, 120),
+    cube_rotation({ 1, 1, -1 }, 240),
 };
 
 extern const std::array<geo::matrix3<float>, 32> arbitrary_rotations;
@@ -46,6 +59,10 @@ inline constexpr std::array<std::span<const geo::matrix3<float>>, 3> rotation_se
     arbitrary_rotations,
 };
 
+// Turns the part so that its bounding box is as small as could be found, resting on a face of its convex hull.
+// Returns the identity if no turn makes the box noticeably smaller.
+geo::matrix3<float> min_box_rotation(const mesh& part_mesh);
+
 } // namespace pstack::calc
 
 #endif // PSTACK_CALC_ROTATIONS_HPP
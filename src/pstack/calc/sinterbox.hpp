@@ -6,6 +6,14 @@
 
 namespace pstack::calc {
 
+// What can be chosen about a sinterbox, where the rest follows from the stack it goes around
+struct sinterbox_settings {
+    double clearance = 0.8;
+    double spacing = 6.0;
+    double thickness = 0.8;
+    double width = 1.1;
+};
+
 struct sinterbox_parameters {
     geo::point3<float> min;
     geo::point3<float> max;
@@ -0,0 +1,172 @@
+#include "pstack/calc/stack_scheduler.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace pstack::calc {
+
+stack_scheduler::stack_scheduler(std::size_t max_jobs, const std::size_t memory_limit)
+    : _memory_limit(memory_limit)
+{
+    const std::size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    if (max_jobs == 0) {
+        max_jobs = hardware_threads;
+    }
+    _threads_per_job = std::max<std::size_t>(1, hardware_threads / max_jobs);
+
+    _workers.reserve(max_jobs);
+    for (std::size_t i = 0; i != max_jobs; ++i) {
+        _workers.emplace_back([this] { work(); });
+    }
+}
+
+stack_scheduler::~stack_scheduler() {
+    std::vector<queued_job> dropped{};
+    {
+        // In one go, so that a job submitted from a callback in between is neither left running nor left in the queue
+        const std::lock_guard lock(_mutex);
+        _stopping = true;
+        dropped = take_all();
+    }
+    _changed.notify_all();
+    for (const queued_job& job : dropped) {
+        job.params.on_finish();
+    }
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+stack_scheduler::job_id stack_scheduler::submit(stack_parameters params, const int priority) {
+    if (params.threads == 0) {
+        params.threads = _threads_per_job;
+    }
+    const std::size_t memory = estimate_memory(params);
+
+    job_id id;
+    bool stopping;
+    {
+        const std::lock_guard lock(_mutex);
+        id = _next_id++;
+        stopping = _stopping;
+        if (not stopping) {
+            _queue.push_back({ id, priority, memory, std::move(params) });
+        }
+    }
+    // Only from a callback of a job stopped by the destructor, which won't start anything new
+    if (stopping) {
+        params.on_finish();
+        return id;
+    }
+    _changed.notify_all();
+    return id;
+}
+
+bool stack_scheduler::cancel(const job_id id) {
+    std::unique_lock lock(_mutex);
+    if (const auto it = std::ranges::find(_queue, id, &queued_job::id); it != _queue.end()) {
+        const stack_parameters params = std::move(it->params);
+        _queue.erase(it);
+        lock.unlock();
+        _changed.notify_all();
+        params.on_finish();
+        return true;
+    }
+    if (const auto it = std::ranges::find(_running, id, &running_job::id); it != _running.end()) {
+        *it->running = false;
+        return true;
+    }
+    return false;
+}
+
+void stack_scheduler::cancel_all() {
+    std::vector<queued_job> dropped{};
+    {
+        const std::lock_guard lock(_mutex);
+        dropped = take_all();
+    }
+    _changed.notify_all();
+
+    // Outside the lock, since these may submit or cancel jobs themselves
+    for (const queued_job& job : dropped) {
+        job.params.on_finish();
+    }
+}
+
+void stack_scheduler::wait() {
+    std::unique_lock lock(_mutex);
+    _changed.wait(lock, [this] { return idle(); });
+}
+
+std::size_t stack_scheduler::queued() const {
+    const std::lock_guard lock(_mutex);
+    return _queue.size();
+}
+
+std::size_t stack_scheduler::running() const {
+    const std::lock_guard lock(_mutex);
+    return _running.size();
+}
+
+// Empties the queue, stops the running jobs, and returns the queued ones for their `on_finish`. Must be called with
+// `_mutex` held.
+std::vector<stack_scheduler::queued_job> stack_scheduler::take_all() {
+    std::vector<queued_job> taken = std::move(_queue);
+    _queue.clear();
+    for (const running_job& job : _running) {
+        *job.running = false;
+    }
+    return taken;
+}
+
+// The job that may start now, if any. Must be called with `_mutex` held.
+std::vector<stack_scheduler::queued_job>::iterator stack_scheduler::next_job() {
+    const auto it = std::ranges::min_element(_queue, [](const queued_job& lhs, const queued_job& rhs) {
+        return lhs.priority != rhs.priority ? lhs.priority > rhs.priority : lhs.id < rhs.id;
+    });
+    if (it == _queue.end()) {
+        return it;
+    }
+    if (_memory_limit != 0 and not _running.empty() and _memory_used + it->memory > _memory_limit) {
+        return _queue.end();
+    }
+    return it;
+}
+
+void stack_scheduler::work() {
+    std::unique_lock lock(_mutex);
+    while (true) {
+        auto it = _queue.end();
+        _changed.wait(lock, [&] {
+            it = next_job();
+            return _stopping or it != _queue.end();
+        });
+        if (_stopping) {
+            // Nothing is queued once the destructor has taken the queue, but whatever is still there gets its `on_finish`
+            const std::vector<queued_job> dropped = std::exchange(_queue, {});
+            lock.unlock();
+            for (const queued_job& job : dropped) {
+                job.params.on_finish();
+            }
+            return;
+        }
+
+        const job_id id = it->id;
+        const std::size_t memory = it->memory;
+        const stack_parameters params = std::move(it->params);
+        _queue.erase(it);
+
+        std::atomic<bool> running = true;
+        _running.push_back({ id, memory, &running });
+        _memory_used += memory;
+        lock.unlock();
+
+        stack(params, running);
+
+        lock.lock();
+        std::erase_if(_running, [id](const running_job& job) { return job.id == id; });
+        _memory_used -= memory;
+        _changed.notify_all();
+    }
+}
+
+} // namespace pstack::calc
@@ -0,0 +1,91 @@
+#ifndef PSTACK_CALC_STACK_SCHEDULER_HPP
+#define PSTACK_CALC_STACK_SCHEDULER_HPP
+
+#include "pstack/calc/stacker.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pstack::calc {
+
+// Runs queued stacking jobs on a fixed number of worker threads.
+// Jobs start in order of priority, then submission. The next job waits while starting it would exceed the memory limit,
+// unless nothing else is running, so that a single large job is never stuck.
+class stack_scheduler {
+public:
+    using job_id = std::size_t;
+
+    // Zero `max_jobs` means one job per hardware thread, and zero `memory_limit` means no limit
+    stack_scheduler(std::size_t max_jobs = 0, std::size_t memory_limit = 0);
+
+    // Cancels every job, and waits for the running ones to stop. Jobs submitted meanwhile, from the callbacks of those
+    // jobs, never start and only get `on_finish`.
+    ~stack_scheduler();
+
+    stack_scheduler(const stack_scheduler&) = delete;
+    stack_scheduler& operator=(const stack_scheduler&) = delete;
+
+    // Jobs that leave `params.threads` at zero get an even share of the hardware threads
+    job_id submit(stack_parameters params, int priority = 0);
+
+    // A queued job is dropped and only gets `on_finish`. A running one stops like `stacker::abort`.
+    // Returns whether the job was still queued or running.
+    bool cancel(job_id id);
+    void cancel_all();
+
+    // Waits until every job is done
+    void wait();
+
+    // Waits until every job is done or `timeout` passes, and returns whether they're all done
+    template <class Rep, class Period>
+    bool wait_for(const std::chrono::duration<Rep, Period>& timeout) {
+        std::unique_lock lock(_mutex);
+        return _changed.wait_for(lock, timeout, [this] { return idle(); });
+    }
+
+    std::size_t queued() const;
+    std::size_t running() const;
+
+private:
+    struct queued_job {
+        job_id id;
+        int priority;
+        std::size_t memory;
+        stack_parameters params;
+    };
+
+    struct running_job {
+        job_id id;
+        std::size_t memory;
+        std::atomic<bool>* running;
+    };
+
+    bool idle() const {
+        return _queue.empty() and _running.empty();
+    }
+
+    std::vector<queued_job> take_all();
+    std::vector<queued_job>::iterator next_job();
+    void work();
+
+    const std::size_t _memory_limit;
+    std::size_t _threads_per_job = 1;
+
+    mutable std::mutex _mutex{};
+    std::condition_variable _changed{};
+    std::vector<queued_job> _queue{};
+    std::vector<running_job> _running{};
+    std::size_t _memory_used = 0;
+    job_id _next_id = 0;
+    bool _stopping = false;
+
+    std::vector<std::thread> _workers{};
+};
+
+} // namespace pstack::calc
+
+#endif // PSTACK_CALC_STACK_SCHEDULER_HPP
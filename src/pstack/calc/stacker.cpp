@@ -1,333 +1,945 @@
-#include "pstack/calc/bool.hpp"
+#include "pstack/calc/indexed_mesh.hpp"
 #include "pstack/calc/mesh.hpp"
+#include "pstack/calc/mesh_arrays.hpp"
+#include "pstack/calc/occupancy.hpp"
 #include "pstack/calc/rotations.hpp"
 #include "pstack/calc/stacker.hpp"
+#include "pstack/calc/voxel_cache.hpp"
 #include "pstack/calc/voxelize.hpp"
+#include "pstack/util/bit_grid.hpp"
 #include "pstack/util/mdarray.hpp"
+#include "pstack/util/thread_pool.hpp"
+#include "pstack/util/trace.hpp"
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <numeric>
 #include <optional>
+#include <random>
 #include <ranges>
+#include <span>
+#include <utility>
 
 namespace pstack::calc {
 
 namespace {
 
+// Counted by each thread over a chunk of work, then added to the totals at once
+struct work_counters {
+    collision_counters collisions{};
+    std::uint64_t can_place_calls = 0;
+};
+
+// Shared by every attempt and thread of one stacking run
+struct run_statistics {
+    std::atomic<std::uint64_t> can_place_calls = 0;
+    std::atomic<std::uint64_t> voxels_tested = 0;
+    std::atomic<std::uint64_t> early_rejections = 0;
+    std::atomic<std::uint64_t> enlargement_rounds = 0;
+    std::atomic<std::uint64_t> cached_orientations = 0;
+    std::atomic<std::chrono::nanoseconds::rep> placement = 0;
+    std::atomic<std::chrono::nanoseconds::rep> enlargement = 0;
+    std::atomic<std::size_t> grid_memory = 0;
+    std::atomic<std::size_t> peak_grid_memory = 0;
+
+    void add(const work_counters& counters) {
+        can_place_calls += counters.can_place_calls;
+        voxels_tested += counters.collisions.voxels_tested;
+        early_rejections += counters.collisions.probe_rejections;
+    }
+
+    void allocate(const std::size_t bytes) {
+        const std::size_t now = grid_memory += bytes;
+        std::size_t peak = peak_grid_memory;
+        while (now > peak and not peak_grid_memory.compare_exchange_weak(peak, now)) {}
+    }
+
+    void release(const std::size_t bytes) {
+        grid_memory -= bytes;
+    }
+};
+
+std::chrono::nanoseconds::rep nanoseconds_since(const std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
 struct stack_state {
     struct mesh_entry {
-        mesh mesh;
+        mesh_arrays mesh;
         geo::vector3<int> box_size;
         stack_result::piece piece;
+        voxel_shape voxels{};
     };
 
-    std::vector<std::vector<mesh_entry>> meshes;
-    std::vector<util::mdarray<int, 3>> voxels;
-    util::mdarray<Bool, 3> space;
-    std::vector<std::shared_ptr<const part>> ordered_parts;
-    stack_result result;
+    // Where the scan for a part resumes. Occupancy only grows, so positions before it can't fit until the box grows.
+    struct scan_cursor {
+        int shell = 0;
+        std::size_t position = 0;
+    };
+
+    struct placement {
+        std::size_t part_index;
+        std::size_t orientation;
+        geo::point3<int> position;
+    };
+
+    const std::vector<std::vector<mesh_entry>>& meshes; // Shared by every attempt
+    run_statistics& statistics;                         // Shared by every attempt
+    std::vector<placement> placements{};
+    std::vector<scan_cursor> cursors{};
+    occupancy_grid space{};
+    geo::vector3<int> extents{}; // Of the parts placed so far
 };
 
-void place(const util::mdspan<Bool, 3> space, const int index, const util::mdspan<const int, 3> obj, const int x, const int y, const int z) {
-    const int max_i = std::min(x + obj.extent(0), space.extent(0));
-    const int max_j = std::min(y + obj.extent(1), space.extent(1));
-    const int max_k = std::min(z + obj.extent(2), space.extent(2));
-    for (int i = x; i < max_i; ++i) {
-        for (int j = y; j < max_j; ++j) {
-            for (int k = z; k < max_k; ++k) {
+// Pack the voxels of orientation `index` into a grid trimmed to the occupied extents
+util::bit_grid pack_voxels(const util::mdspan<const int, 3> voxels, const int index) {
+    const util::trace_scope trace("pack_voxels");
+    std::size_t size_x = 0;
+    std::size_t size_y = 0;
+    std::size_t size_z = 0;
+    for (std::size_t i = 0; i < voxels.extent(0); ++i) {
+        for (std::size_t j = 0; j < voxels.extent(1); ++j) {
+            for (std::size_t k = 0; k < voxels.extent(2); ++k) {
 #if defined(MDSPAN_USE_BRACKET_OPERATOR) and MDSPAN_USE_BRACKET_OPERATOR == 0
-                space(i, j, k) |= (obj(i - x, j - y, k - z) & index) != 0;
+                if ((voxels(i, j, k) & index) != 0) {
 #else
-                space[i, j, k] |= (obj[i - x, j - y, k - z] & index) != 0;
+                if ((voxels[i, j, k] & index) != 0) {
 #endif
+                    size_x = std::max(size_x, i + 1);
+                    size_y = std::max(size_y, j + 1);
+                    size_z = std::max(size_z, k + 1);
+                }
             }
         }
     }
-}
 
-int can_place(const util::mdspan<const Bool, 3> space, int possible, const util::mdspan<const int, 3> obj, const std::size_t x, const std::size_t y, const std::size_t z) {
-    const std::size_t max_i = std::min(x + obj.extent(0), space.extent(0));
-    const std::size_t max_j = std::min(y + obj.extent(1), space.extent(1));
-    const std::size_t max_k = std::min(z + obj.extent(2), space.extent(2));
-    for (std::size_t i = x; i < max_i; ++i) {
-        for (std::size_t j = y; j < max_j; ++j) {
-            for (std::size_t k = z; k < max_k; ++k) {
+    util::bit_grid out(size_x, size_y, size_z);
+    for (std::size_t i = 0; i < size_x; ++i) {
+        for (std::size_t j = 0; j < size_y; ++j) {
+            for (std::size_t k = 0; k < size_z; ++k) {
 #if defined(MDSPAN_USE_BRACKET_OPERATOR) and MDSPAN_USE_BRACKET_OPERATOR == 0
-                if (space(i, j, k)) {
-                    possible &= (possible ^ obj(i - x, j - y, k - z));
+                if ((voxels(i, j, k) & index) != 0) {
 #else
-                if (space[i, j, k]) {
-                    possible &= (possible ^ obj[i - x, j - y, k - z]);
+                if ((voxels[i, j, k] & index) != 0) {
 #endif
-                    if (possible == 0) {
-                        return 0;
-                    }
+                    out.set(i, j, k);
+                }
+            }
+        }
+    }
+    return out;
+}
+
+// A change of orientation that only swaps and flips axes: axis `a` of the new orientation is axis `source[a]` of the old one,
+// running the other way if `flipped[a]`
+struct axis_permutation {
+    std::array<int, 3> source;
+    std::array<bool, 3> flipped;
+};
+
+std::optional<axis_permutation> as_axis_permutation(const geo::matrix3<float>& rotation) {
+    const float rows[3][3] = {
+        { rotation.xx, rotation.xy, rotation.xz },
+        { rotation.yx, rotation.yy, rotation.yz },
+        { rotation.zx, rotation.zy, rotation.zz },
+    };
+    axis_permutation out{};
+    std::array<bool, 3> used{};
+    for (int a = 0; a != 3; ++a) {
+        int source = -1;
+        for (int b = 0; b != 3; ++b) {
+            if (rows[a][b] == 0) {
+                continue;
+            }
+            if ((rows[a][b] != 1 and rows[a][b] != -1) or source != -1) {
+                return std::nullopt;
+            }
+            source = b;
+            out.flipped[a] = rows[a][b] < 0;
+        }
+        if (source == -1 or used[source]) {
+            return std::nullopt;
+        }
+        used[source] = true;
+        out.source[a] = source;
+    }
+    return out;
+}
+
+// The voxels of a part turned by `permutation`, which span the same cells of space as `voxels` when turned
+util::bit_grid permute_voxels(const util::bit_grid& voxels, const axis_permutation& permutation) {
+    const util::trace_scope trace("permute_voxels");
+    std::array<std::size_t, 3> extents;
+    for (int a = 0; a != 3; ++a) {
+        extents[a] = voxels.extent(permutation.source[a]);
+    }
+    util::bit_grid out(extents[0], extents[1], extents[2]);
+
+    // Rows along z stay whole when z stays put
+    const bool same_rows = permutation.source[2] == 2 and not permutation.flipped[2];
+    std::array<std::size_t, 3> from;
+    for (from[0] = 0; from[0] != voxels.extent(0); ++from[0]) {
+        for (from[1] = 0; from[1] != voxels.extent(1); ++from[1]) {
+            const auto row = voxels.row(from[0], from[1]);
+            const auto to = [&](const int a) {
+                const std::size_t coordinate = from[permutation.source[a]];
+                return permutation.flipped[a] ? extents[a] - 1 - coordinate : coordinate;
+            };
+            if (same_rows) {
+                std::ranges::copy(row, out.row(to(0), to(1)).begin());
+                continue;
+            }
+            for (std::size_t i = 0; i != row.size(); ++i) {
+                for (util::bit_grid::word_type bits = row[i]; bits != 0; bits &= bits - 1) {
+                    from[2] = i * util::bit_grid::word_bits + std::countr_zero(bits);
+                    out.set(to(0), to(1), to(2));
                 }
             }
         }
     }
+    return out;
+}
+
+// Marks the voxels of a placed part as occupied
+void occupy(stack_state& state, const stack_state::placement& placement) {
+    const auto& [mesh, box_size, piece, voxels] = state.meshes[placement.part_index][placement.orientation];
+    const auto [x, y, z] = placement.position;
+    state.space.place(voxels, x, y, z);
+    state.extents = {
+        std::max(state.extents.x, x + box_size.x),
+        std::max(state.extents.y, y + box_size.y),
+        std::max(state.extents.z, z + box_size.z),
+    };
+    state.placements.push_back(placement);
+}
+
+// Rebuilds the occupied space from the placements, after some of them were taken out
+void rebuild(stack_state& state) {
+    auto placements = std::move(state.placements);
+    state.placements.clear();
+    state.space = occupancy_grid(state.space.extent(0), state.space.extent(1), state.space.extent(2));
+    state.extents = {};
+    for (const auto& placement : placements) {
+        occupy(state, placement);
+    }
+}
+
+geo::vector3<float> translation_of(const stack_state::placement& placement) {
+    return { (float)placement.position.x, (float)placement.position.y, (float)placement.position.z };
+}
+
+// Builds the mesh of the placements from `first` onwards, scaled by `factor`.
+// Every triangle is written straight into its final slot, so the pieces are transformed in parallel and nothing is copied twice.
+mesh placed_mesh(const stack_state& state, const std::size_t first, const double factor, util::thread_pool& pool) {
+    const util::trace_scope trace("placed_mesh");
+    const auto entry = [&](const stack_state::placement& placement) -> const auto& {
+        return state.meshes[placement.part_index][placement.orientation];
+    };
+
+    const std::span placements = std::span(state.placements).subspan(first);
+    std::vector<std::size_t> offsets(placements.size() + 1, 0);
+    for (std::size_t i = 0; i != placements.size(); ++i) {
+        offsets[i + 1] = offsets[i] + entry(placements[i]).mesh.size();
+    }
+
+    std::vector<geo::triangle> triangles(offsets.back());
+    pool.for_each_index(placements.size(), [&](const std::size_t i) {
+        const geo::vector3<float> translation = translation_of(placements[i]);
+        const mesh_arrays& placed = entry(placements[i]).mesh;
+        auto out = triangles.begin() + offsets[i];
+        for (std::size_t j = 0; j != placed.size(); ++j) {
+            const geo::triangle t = placed.triangle(j);
+            *out++ = {
+                .normal = t.normal,
+                .v1 = geo::origin3<float> + (factor * (t.v1 + translation).as_vector()),
+                .v2 = geo::origin3<float> + (factor * (t.v2 + translation).as_vector()),
+                .v3 = geo::origin3<float> + (factor * (t.v3 + translation).as_vector()),
+            };
+        }
+    });
+    return mesh(std::move(triangles));
+}
+
+// The finished stack, built once from the placements, and scaled by `factor` back from voxels
+stack_result assemble(const stack_state& state, const double factor, util::thread_pool& pool) {
+    stack_result out{};
+    out.pieces.reserve(state.placements.size());
+    for (const auto& placement : state.placements) {
+        auto& piece = out.pieces.emplace_back(state.meshes[placement.part_index][placement.orientation].piece);
+        piece.translation = factor * (piece.translation + translation_of(placement));
+    }
+    out.mesh = placed_mesh(state, 0, factor, pool);
+    return out;
+}
+
+int can_place(const occupancy_grid& space, int possible, const std::vector<stack_state::mesh_entry>& entries, const std::size_t x, const std::size_t y, const std::size_t z, work_counters& counters) {
+    ++counters.can_place_calls;
+    int bit_index = 1;
+    for (const auto& entry : entries) {
+        if ((possible & bit_index) != 0 and space.collides(entry.voxels, x, y, z, counters.collisions)) {
+            possible &= ~bit_index;
+            if (possible == 0) {
+                return 0;
+            }
+        }
+        bit_index *= 2;
+    }
     return possible;
 }
 
-std::size_t try_place(const stack_parameters& params, stack_state& state, const std::size_t part_index, const std::size_t to_place, const geo::point3<int> max) {
+int fitting_orientations(const stack_state& state, const std::size_t part_index, const geo::point3<int> position, const geo::point3<int> max, work_counters& counters) {
+    const auto [x, y, z] = position;
+
+    // Calculate which orientations fit in bounding box
+    int bit_index = 1;
+    int possible = 0;
+    for (const auto& [mesh, box_size, piece, voxels] : state.meshes[part_index]) {
+        if (x + box_size.x < max.x && y + box_size.y < max.y && z + box_size.z < max.z) {
+            possible |= bit_index;
+        }
+        bit_index *= 2;
+    }
+
+    return can_place(state.space, possible, state.meshes[part_index], x, y, z, counters);
+}
+
+// Returns the index of the first position where the part fits, which is the same one a sequential scan would find.
+// Chunks of positions are searched in parallel, and any chunk after an already found fit is skipped.
+std::optional<std::size_t> find_first_fit(const stack_state& state, util::thread_pool& pool, const std::size_t part_index, const std::span<const geo::point3<int>> positions, const geo::point3<int> max) {
+    static constexpr std::size_t chunk_size = 64;
+    std::atomic<std::size_t> first = positions.size();
+    pool.for_each_index((positions.size() + chunk_size - 1) / chunk_size, [&](const std::size_t chunk) {
+        work_counters counters{};
+        const std::size_t chunk_end = std::min(positions.size(), (chunk + 1) * chunk_size);
+        for (std::size_t i = chunk * chunk_size; i < chunk_end and i < first; ++i) {
+            if (fitting_orientations(state, part_index, positions[i], max, counters) != 0) {
+                std::size_t current = first;
+                while (i < current and not first.compare_exchange_weak(current, i)) {}
+                break;
+            }
+        }
+        state.statistics.add(counters);
+    });
+    if (first == positions.size()) {
+        return std::nullopt;
+    }
+    return first;
+}
+
+std::size_t try_place(stack_state& state, util::thread_pool& pool, const std::size_t part_index, const std::size_t to_place, const geo::point3<int> max) {
+    const util::trace_scope trace("try_place");
     std::size_t placed = 0;
-    for (int s = 0; s <= max.x + max.y + max.z; ++s) {
+    std::vector<geo::point3<int>> shell{};
+    auto& cursor = state.cursors[part_index];
+    for (int s = cursor.shell; s <= max.x + max.y + max.z; ++s) {
+        // Gather the positions of this diagonal shell, in scan order
+        shell.clear();
         for (int r = std::max(0, s - max.z); r <= std::min(s, max.x + max.y); ++r) {
             const int z = s - r;
             for (int x = std::max(0, r - max.y); x <= std::min(r, max.x); ++x) {
                 const int y = r - x;
+                shell.push_back({ x, y, z });
+            }
+        }
 
-                // Calculate which orientations fit in bounding box
-                int bit_index = 1;
-                int possible = 0;
-                for (const auto& [mesh, box_size, piece] : state.meshes[part_index]) {
-                    if (x + box_size.x < max.x && y + box_size.y < max.y && z + box_size.z < max.z) {
-                        possible |= bit_index;
-                    }
-                    bit_index *= 2;
-                }
-
-                possible = can_place(state.space, possible, state.voxels[part_index], x, y, z);
-
-                if (possible != 0) { // If it fits, figure out which rotation to use
-                    bit_index = 1;
-                    for (const auto& [mesh, box_size, piece] : state.meshes[part_index]) {
-                        if ((possible & bit_index) == 0) {
-                            bit_index *= 2;
-                            continue;
-                        } else {
-                            const geo::vector3<float> translation = { (float)x, (float)y, (float)z };
-                            state.result.mesh.add(mesh, translation);
-                            auto& new_piece = state.result.pieces.emplace_back(piece);
-                            new_piece.translation += translation;
-                            place(state.space, bit_index, state.voxels[part_index], x, y, z); // Mark voxels as occupied
-                            ++placed;
-                            if (to_place == placed) { // All instances of this part placed, move to next part
-                                return placed;
-                            } else { // Move to next instance of part
-                                break;
-                            }
-                        }
-                    }
-                }
+        std::size_t begin = (s == cursor.shell) ? cursor.position : 0;
+        while (const auto found = find_first_fit(state, pool, part_index, std::span(shell).subspan(begin), max)) {
+            const auto [x, y, z] = shell[begin + *found];
+            begin += *found + 1;
+            cursor = { s, begin };
+
+            // It fits, so use the first rotation that does
+            work_counters counters{};
+            const int possible = fitting_orientations(state, part_index, { x, y, z }, max, counters);
+            state.statistics.add(counters);
+            occupy(state, { part_index, static_cast<std::size_t>(std::countr_zero(static_cast<unsigned>(possible))), { x, y, z } });
+            ++placed;
+            if (to_place == placed) { // All instances of this part placed, move to next part
+                return placed;
             }
         }
     }
 
     // Reached the end of the box, return the part we're currently at.
+    cursor = { max.x + max.y + max.z + 1, 0 };
     return placed;
 }
 
-std::optional<stack_result> stack_impl(const stack_parameters& params, const std::atomic<bool>& running) {
-    stack_state state{};
-    state.ordered_parts = params.parts;
-    std::ranges::sort(state.ordered_parts, std::greater{}, &part::volume);
-    state.meshes.assign(state.ordered_parts.size(), {});
-    state.voxels.assign(state.ordered_parts.size(), {});
+// Finds the size of the smallest box that one more instance of the part fits into, once it no longer fits into `max`.
+// Shells are visited and cut short just like a sequential scan would, so the same box is chosen, but the positions of each shell are tested in parallel.
+// `try_place` must have just searched all of `max` for the part without finding room. Occupancy has only grown since, so
+// every orientation that stays inside `max` is known to collide wherever it was tried, and only the ones reaching into the
+// grown part of the box are tested.
+std::optional<geo::vector3<int>> find_enlargement(const stack_state& state, util::thread_pool& pool, const std::size_t part_index, const geo::point3<int> max) {
+    const util::trace_scope trace("find_enlargement");
+    const auto& entries = state.meshes[part_index];
+    int min_box_x = std::numeric_limits<int>::max();
+    int min_box_y = std::numeric_limits<int>::max();
+    int min_box_z = std::numeric_limits<int>::max();
+    int max_box_x = 0;
+    int max_box_y = 0;
+    int max_box_z = 0;
+    for (const auto& [mesh, box_size, piece, voxels] : entries) {
+        min_box_x = std::min(box_size.x, min_box_x);
+        min_box_y = std::min(box_size.y, min_box_y);
+        min_box_z = std::min(box_size.z, min_box_z);
+        max_box_x = std::max(box_size.x, max_box_x);
+        max_box_y = std::max(box_size.y, max_box_y);
+        max_box_z = std::max(box_size.z, max_box_z);
+    }
 
-    double triangles = 0;
-    const double scale_factor = 1 / params.resolution;
-    int total_parts = 0;
-    for (const std::shared_ptr<const part> part : state.ordered_parts) {
-        triangles += part->triangle_count * rotation_sets[part->rotation_index].size();
-        total_parts += part->quantity;
+    // Signed, so that the bounds below can go negative. The room left for the corner of the part along each axis is
+    // negative when none of its orientations fit in the space at all.
+    const int extent_x = static_cast<int>(state.space.extent(0));
+    const int extent_y = static_cast<int>(state.space.extent(1));
+    const int extent_z = static_cast<int>(state.space.extent(2));
+    const int room_x = extent_x - min_box_x;
+    const int room_y = extent_y - min_box_y;
+    const int room_z = extent_z - min_box_z;
+    if (room_x < 0 or room_y < 0 or room_z < 0) {
+        return std::nullopt;
     }
 
-    double progress = 0;
-    for (int i = 0; i < state.ordered_parts.size(); ++i) {
-        geo::matrix3 base_rotation = geo::eye3<float>;
-
-        if (state.ordered_parts[i]->rotate_min_box) {
-            auto reduced_view = state.ordered_parts[i]->mesh.triangles()
-                              | std::views::filter([i = 0](auto&&) mutable { return i++ % 16 == 0; });
-            mesh reduced_mesh{ std::vector<geo::triangle>(reduced_view.begin(), reduced_view.end()) };
-
-            static constexpr std::size_t sections = 20;
-            static constexpr double angle_diff = 2 * geo::pi / sections;
-
-            static constexpr geo::matrix3 rot_x = geo::rot3_x<float>(angle_diff);
-            static constexpr geo::matrix3 rot_y = geo::rot3_y<float>(angle_diff);
-
-            int min_box_volume = std::numeric_limits<int>::max();
-            double best_x = 0;
-            double best_y = 0;
-
-            for (double x = 0; x < 2 * geo::pi; x += angle_diff) {
-                reduced_mesh.rotate(rot_x);
-                for (double y = 0; y < 2 * geo::pi; y += angle_diff) {
-                    reduced_mesh.rotate(rot_y);
-                    const auto box = reduced_mesh.bounding().box_size;
-                    const int box_volume = box.x * box.y * box.z;
-                    if (box_volume < min_box_volume) {
-                        min_box_volume = box_volume;
-                        best_x = x;
-                        best_y = y;
-                    }
+    // Whether `try_place` tried this orientation here, the way `fitting_orientations` rules orientations in
+    const auto scanned = [&](const int x, const int y, const int z, const geo::vector3<int> box_size) {
+        return x >= 0 and y >= 0 and z >= 0 and x + box_size.x < max.x and y + box_size.y < max.y and z + box_size.z < max.z;
+    };
+
+    struct candidate {
+        int volume = std::numeric_limits<int>::max();
+        geo::vector3<int> size{};
+    };
+
+    // The smallest box for a position, without testing orientations that can't beat `bound`
+    const auto evaluate = [&](const int x, const int y, const int z, const int bound, std::vector<std::pair<int, std::size_t>>& order, work_counters& counters) {
+        order.clear();
+        for (std::size_t i = 0; i != entries.size(); ++i) {
+            const auto box_size = entries[i].box_size;
+            if (scanned(x, y, z, box_size)) {
+                continue;
+            }
+            if (x + box_size.x < extent_x && y + box_size.y < extent_y && z + box_size.z < extent_z) {
+                const int new_box = std::max(max.x, x + box_size.x) * std::max(max.y, y + box_size.y) * std::max(max.z, z + box_size.z);
+                if (new_box < bound) {
+                    order.emplace_back(new_box, i);
                 }
             }
+        }
 
-            base_rotation = geo::rot3_y<float>(best_y) * geo::rot3_x<float>(best_x);
+        // Ties go to the first orientation, so the first one that fits in this order is the one a full scan would pick
+        std::ranges::sort(order);
+        for (const auto& [new_box, i] : order) {
+            if (not state.space.collides(entries[i].voxels, x, y, z, counters.collisions)) {
+                const auto box_size = entries[i].box_size;
+                return candidate{ new_box, { x + box_size.x, y + box_size.y, z + box_size.z } };
+            }
         }
+        return candidate{};
+    };
 
-        // Set up array of parts
-        const auto rotations = rotation_sets[state.ordered_parts[i]->rotation_index];
-        state.meshes[i].reserve(rotations.size());
+    struct row {
+        int z;
+        std::size_t begin;
+        std::size_t end;
+    };
 
-        // Track bounding box size
-        geo::vector3<int> max_box_size = { 1, 1, 1 };
+    static constexpr std::size_t chunk_size = 64;
+    std::optional<geo::vector3<int>> out{};
+    int best = std::numeric_limits<int>::max();
+    std::vector<row> rows{};
+    std::vector<geo::point3<int>> positions{};
+    std::vector<candidate> candidates{};
+    for (int s = 0; s < room_x + room_y + room_z; ++s) {
+        // Gather the positions of this shell that may beat the best box so far, row by row
+        rows.clear();
+        positions.clear();
+        for (int r = std::max(0, s - room_z); r <= std::min(s, room_x + room_y); ++r) {
+            const int z = s - r;
+            if (std::max(z + min_box_z, max.z) * max.y * max.x > best) {
+                break;
+            }
 
-        // Calculate all the rotations
-        for (const auto& rotation : rotations) {
-            if (not running) {
-                return std::nullopt;
+            rows.push_back({ z, positions.size(), positions.size() });
+            for (int x = std::max(0, r - room_y); x <= std::min(r, room_x); ++x) {
+                const int y = r - x;
+                if (std::max(x + min_box_x, max.x) * std::max(y + min_box_y, max.y) * std::max(z + min_box_z, max.z) > best) {
+                    continue;
+                }
+                if (scanned(x, y, z, { max_box_x, max_box_y, max_box_z })) {
+                    continue; // Every orientation was tried here
+                }
+                positions.push_back({ x, y, z });
             }
+            rows.back().end = positions.size();
+        }
+        if (positions.empty()) {
+            continue;
+        }
 
-            const std::shared_ptr<const part> part = state.ordered_parts[i];
-            mesh m = part->mesh;
-            m.scale(scale_factor);
-            auto total_rotation = base_rotation * rotation;
-            m.rotate(total_rotation);
-            auto offset = m.set_baseline({ 0, 0, 0 });
-
-            const auto box_size = m.bounding().box_size;
-            max_box_size.x = std::max(box_size.x, max_box_size.x);
-            max_box_size.y = std::max(box_size.y, max_box_size.y);
-            max_box_size.z = std::max(box_size.z, max_box_size.z);
-
-            stack_result::piece piece = { .part = part, .rotation = total_rotation, .translation = offset };
-#if defined(__cpp_aggregate_paren_init) and __cpp_aggregate_paren_init >= 201902L
-            state.meshes[i].emplace_back(std::move(m), box_size, std::move(piece));
-#else
-            state.meshes[i].push_back(stack_state::mesh_entry{std::move(m), box_size, std::move(piece)});
-#endif
+        candidates.assign(positions.size(), {});
+        const int bound = best;
+        pool.for_each_index((positions.size() + chunk_size - 1) / chunk_size, [&](const std::size_t chunk) {
+            std::vector<std::pair<int, std::size_t>> order{};
+            work_counters counters{};
+            const std::size_t chunk_end = std::min(positions.size(), (chunk + 1) * chunk_size);
+            for (std::size_t i = chunk * chunk_size; i < chunk_end; ++i) {
+                const auto [x, y, z] = positions[i];
+                candidates[i] = evaluate(x, y, z, bound, order, counters);
+            }
+            state.statistics.add(counters);
+        });
 
-            progress += part->triangle_count / 2;
-            params.set_progress(progress, triangles);
+        // Take the candidates in scan order, stopping at the same row a sequential scan would
+        for (const auto& [z, begin, end] : rows) {
+            if (std::max(z + min_box_z, max.z) * max.y * max.x > best) {
+                break;
+            }
+            for (std::size_t i = begin; i != end; ++i) {
+                if (candidates[i].volume < best) {
+                    best = candidates[i].volume;
+                    out = candidates[i].size;
+                }
+            }
         }
+    }
+    return out;
+}
 
-        // Initialize space size to appropriate dimensions
-        state.voxels[i] = { max_box_size.x, max_box_size.y, max_box_size.z };
+// Shared between the attempts of one stacking run
+struct portfolio {
+    int total_parts;
+    std::atomic<int> best_volume = std::numeric_limits<int>::max(); // Of the finished attempts, in voxels
+    std::mutex mutex{};
+    std::size_t most_placed = 0; // Guarded by `mutex`
+
+    // What the previews have shown so far, guarded by `mutex`
+    const stack_state* previewed = nullptr;
+    std::size_t previewed_placements = 0;
+    std::chrono::steady_clock::time_point last_preview{};
+};
 
-        // Voxelize each rotated instance of this part
-        int bit_index = 1;
-        for (const auto& [mesh, box_size, piece] : state.meshes[i]) {
-            if (not running) {
-                return std::nullopt;
-            }
+// Shows the placements of `state` made since the last preview, or all of them when the last preview was of another attempt.
+// Previews closer together than `params.preview_interval` are skipped, and the next one catches up. Needs `shared.mutex` held.
+void preview(const stack_parameters& params, const stack_state& state, util::thread_pool& pool, const geo::vector3<int> box, portfolio& shared) {
+    if (not params.display_preview) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now - shared.last_preview < params.preview_interval) {
+        return;
+    }
+    shared.last_preview = now;
 
-            voxelize(mesh, state.voxels[i], bit_index, state.ordered_parts[i]->min_hole);
-            bit_index *= 2;
+    const bool reset = shared.previewed != &state;
+    mesh added = placed_mesh(state, reset ? 0 : shared.previewed_placements, 1, pool);
+    shared.previewed = &state;
+    shared.previewed_placements = state.placements.size();
+    params.display_preview({ .added = std::move(added), .reset = reset, .box = box });
+}
+
+// The order in which each attempt places the parts: by volume, by largest dimension, then by volume with seeded random perturbations.
+// `parts` must already be sorted by volume, and orders that repeat an earlier one are dropped.
+std::vector<std::vector<std::size_t>> part_orders(const std::vector<std::shared_ptr<const part>>& parts, const std::vector<geo::vector3<int>>& max_box_sizes, const std::size_t attempts) {
+    std::vector<std::size_t> by_volume(parts.size());
+    std::iota(by_volume.begin(), by_volume.end(), 0);
+    std::vector<std::vector<std::size_t>> out{ by_volume };
 
-            progress += state.ordered_parts[i]->triangle_count / 2;
-            params.set_progress(progress, triangles);
+    const auto add = [&](std::vector<std::size_t> order) {
+        if (std::ranges::find(out, order) == out.end()) {
+            out.push_back(std::move(order));
         }
+    };
+    if (attempts > 1) {
+        auto by_dimension = by_volume;
+        std::ranges::stable_sort(by_dimension, std::greater{}, [&](const std::size_t i) {
+            return std::max({ max_box_sizes[i].x, max_box_sizes[i].y, max_box_sizes[i].z });
+        });
+        add(std::move(by_dimension));
     }
+    for (std::size_t seed = 2; seed < attempts; ++seed) {
+        // Scale each volume by a random factor in [0.5, 1.5], using the engine directly as its output is the same everywhere
+        std::mt19937 random(static_cast<std::mt19937::result_type>(seed));
+        std::vector<double> keys(parts.size());
+        for (std::size_t i = 0; i != parts.size(); ++i) {
+            keys[i] = parts[i]->volume * (0.5 + static_cast<double>(random()) / std::mt19937::max());
+        }
+        auto perturbed = by_volume;
+        std::ranges::stable_sort(perturbed, std::greater{}, [&](const std::size_t i) { return keys[i]; });
+        add(std::move(perturbed));
+    }
+    return out;
+}
 
-    int max_x = static_cast<int>(scale_factor * params.x_min);
-    int max_y = static_cast<int>(scale_factor * params.y_min);
-    int max_z = static_cast<int>(scale_factor * params.z_min);
-    state.space = {
-        std::max(max_x, static_cast<int>(scale_factor * params.x_max)),
-        std::max(max_y, static_cast<int>(scale_factor * params.y_max)),
-        std::max(max_z, static_cast<int>(scale_factor * params.z_max))
-    };
+enum class pack_outcome {
+    packed,
+    no_fit,  // The parts don't fit in the space
+    stopped, // Stopped, or beaten by another attempt
+};
 
-    params.set_progress(0, 1);
+// Places the parts in the given order, enlarging the box from `initial` as needed.
+// Only the placements are recorded, and the mesh of the winning attempt is built at the end.
+pack_outcome pack(const stack_parameters& params, stack_state& state, util::thread_pool& pool, const std::vector<std::shared_ptr<const part>>& parts, const std::span<const std::size_t> order, const geo::point3<int> initial, portfolio& shared, const std::atomic<bool>& running) {
+    const util::trace_scope trace("pack");
+    int max_x = initial.x;
+    int max_y = initial.y;
+    int max_z = initial.z;
 
     std::size_t total_placed = 0;
-    for (std::size_t part_index = 0; part_index != state.ordered_parts.size(); ++part_index) {
-        std::size_t to_place = state.ordered_parts[part_index]->quantity;
+    for (const std::size_t part_index : order) {
+        std::size_t to_place = parts[part_index]->quantity;
         while (to_place > 0) {
-            if (not running) {
-                return std::nullopt;
+            // Give up as soon as this attempt can no longer beat a finished one
+            if (not running or state.extents.x * state.extents.y * state.extents.z > shared.best_volume) {
+                return pack_outcome::stopped;
             }
-            const std::size_t placed = try_place(params, state, part_index, to_place, { max_x, max_y, max_z });
+            const auto placement_start = std::chrono::steady_clock::now();
+            const std::size_t placed = try_place(state, pool, part_index, to_place, { max_x, max_y, max_z });
+            state.statistics.placement += nanoseconds_since(placement_start);
             to_place -= placed;
             total_placed += placed;
-            params.set_progress(total_placed, total_parts);
-            params.display_mesh(state.result.mesh, max_x, max_y, max_z);
+            {
+                // Only the attempt furthest along shows its progress
+                const std::lock_guard lock(shared.mutex);
+                if (total_placed >= shared.most_placed) {
+                    shared.most_placed = total_placed;
+                    params.set_progress(total_placed, shared.total_parts);
+                    preview(params, state, pool, { max_x, max_y, max_z }, shared);
+                }
+            }
 
             // If we have not placed a part, it means there are no more ways to place an instance of the current part in the box: it must be enlarged
             if (placed == 0) {
-                int best = std::numeric_limits<int>::max();
-                int new_x = state.space.extent(0);
-                int new_y = state.space.extent(1);
-                int new_z = state.space.extent(2);
-
-                int min_box_x = std::numeric_limits<int>::max();
-                int min_box_y = std::numeric_limits<int>::max();
-                int min_box_z = std::numeric_limits<int>::max();
-                for (const auto& [mesh, box_size, piece] : state.meshes[part_index]) {
-                    min_box_x = std::min(box_size.x, min_box_x);
-                    min_box_y = std::min(box_size.y, min_box_y);
-                    min_box_z = std::min(box_size.z, min_box_z);
+                const auto enlargement_start = std::chrono::steady_clock::now();
+                const auto size = find_enlargement(state, pool, part_index, { max_x, max_y, max_z });
+                state.statistics.enlargement += nanoseconds_since(enlargement_start);
+                ++state.statistics.enlargement_rounds;
+                if (not size) {
+                    return pack_outcome::no_fit;
                 }
 
-                for (int s = 0; s < state.space.extent(0) + state.space.extent(1) + state.space.extent(2) - min_box_x - min_box_y - min_box_z; ++s) {
-                    for (int r = std::max<std::size_t>(0, s - state.space.extent(2) - min_box_z); r <= std::min<std::size_t>(s, state.space.extent(0) + state.space.extent(1) - min_box_x - min_box_y); ++r) {
-                        const int z = s - r;
-                        if (std::max(z + min_box_z, max_z) * max_y * max_x > best) {
-                            break;
-                        }
-
-                        for (int x = std::max<std::size_t>(0, r - state.space.extent(1) - min_box_y); x <= std::min<std::size_t>(r, state.space.extent(0) - min_box_z); ++x) {
-                            const int y = r - x;
-                            if (std::max(x + min_box_x, max_x) * std::max(y + min_box_y, max_y) * std::max(z + min_box_z, max_z) > best) {
-                                continue;
-                            }
-
-                            // Calculate which orientations fit in bounding box
-                            int bit_index = 1;
-                            int possible = 0;
-                            for (const auto& [mesh, box_size, piece] : state.meshes[part_index]) {
-                                if (x + box_size.x < state.space.extent(0) && y + box_size.y < state.space.extent(1) && z + box_size.z < state.space.extent(2)) {
-                                    possible |= bit_index;
-                                }
-                                bit_index *= 2;
-                            }
-
-                            possible = can_place(state.space, possible, state.voxels[part_index], x, y, z);
-
-                            if (possible != 0) { // If it fits, figure out which rotation to use
-                                bit_index = 1;
-                                for (const auto& [mesh, box_size, piece] : state.meshes[part_index]) {
-                                    if ((possible & bit_index) != 0) {
-                                        const int new_box = std::max(max_x, x + box_size.x) * std::max(max_y, y + box_size.y) * std::max(max_z, z + box_size.z);
-                                        if (new_box < best) {
-                                            best = new_box;
-                                            new_x = x + box_size.x;
-                                            new_y = y + box_size.y;
-                                            new_z = z + box_size.z;
-                                        }
-                                    }
-                                    bit_index *= 2;
-                                }
-                            }
-                        }
-                    }
-                }
+                max_x = std::max(max_x, size->x + 2);
+                max_y = std::max(max_y, size->y + 2);
+                max_z = std::max(max_z, size->z + 2);
+                std::ranges::fill(state.cursors, stack_state::scan_cursor{});
+            }
+        }
+    }
 
-                if (best == std::numeric_limits<int>::max()) {
-                    return stack_result{};
-                }
+    // Let worse attempts stop early
+    const int volume = state.extents.x * state.extents.y * state.extents.z;
+    int best = shared.best_volume;
+    while (volume < best and not shared.best_volume.compare_exchange_weak(best, volume)) {}
+    return pack_outcome::packed;
+}
+
+// Tries to shrink the box until the time runs out or stacking is stopped.
+// Each round takes out the parts touching one face of the box, along with a couple of random others to make room,
+// then puts them back, largest first, into a box one voxel smaller along that axis. Rounds that can't fit everything back are undone.
+void improve(const stack_parameters& params, stack_state& state, util::thread_pool& pool, portfolio& shared, const std::atomic<bool>& running) {
+    const util::trace_scope trace("improve");
+    const auto deadline = std::chrono::steady_clock::now() + params.improve_time;
+    const auto along = [](const auto& v, const int axis) { return axis == 0 ? v.x : axis == 1 ? v.y : v.z; };
+    std::mt19937 random{};
+    while (running and std::chrono::steady_clock::now() < deadline) {
+        const int axis = static_cast<int>(random() % 3);
+        const auto saved = state.placements;
+        const auto extents = state.extents;
+
+        std::vector<stack_state::placement> removed{};
+        state.placements.clear();
+        for (const auto& placement : saved) {
+            const auto box_size = state.meshes[placement.part_index][placement.orientation].box_size;
+            if (along(placement.position, axis) + along(box_size, axis) >= along(extents, axis) or random() % saved.size() < 2) {
+                removed.push_back(placement);
+            } else {
+                state.placements.push_back(placement);
+            }
+        }
+        rebuild(state);
+
+        // Parts are sorted by volume, so this puts the largest back first
+        std::ranges::stable_sort(removed, {}, &stack_state::placement::part_index);
+        const geo::point3<int> max = { extents.x + (axis != 0), extents.y + (axis != 1), extents.z + (axis != 2) };
+        std::ranges::fill(state.cursors, stack_state::scan_cursor{});
+        const bool fits = std::ranges::all_of(removed, [&](const stack_state::placement& placement) {
+            return try_place(state, pool, placement.part_index, 1, max) == 1;
+        });
+
+        if (fits) {
+            // The placements were shuffled, so the next preview starts over. It shows the box the parts were put back into,
+            // as `pack` shows the box it places into.
+            const std::lock_guard lock(shared.mutex);
+            shared.previewed = nullptr;
+            preview(params, state, pool, { max.x, max.y, max.z }, shared);
+        } else {
+            state.placements = saved;
+            rebuild(state);
+        }
+    }
+}
+
+std::optional<stack_result> stack_impl(const stack_parameters& params, const std::atomic<bool>& running) {
+    const util::trace_scope trace("stack_impl");
+    util::thread_pool pool(params.threads);
+    run_statistics statistics{};
+    stack_statistics phases{};
+    auto phase_start = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<const part>> ordered_parts = params.parts;
+    std::ranges::sort(ordered_parts, std::greater{}, &part::volume);
+    std::vector<std::vector<stack_state::mesh_entry>> meshes(ordered_parts.size());
+
+    double triangles = 0;
+    const double scale_factor = 1 / params.resolution;
+    int total_parts = 0;
+    for (const std::shared_ptr<const part> part : ordered_parts) {
+        triangles += part->triangle_count * rotation_sets[part->rotation_index].size();
+        total_parts += part->quantity;
+    }
+
+    // One task for every orientation of every part
+    struct orientation_task {
+        std::size_t part_index;
+        std::size_t rotation_index;
+    };
+    std::vector<orientation_task> tasks{};
+    for (std::size_t i = 0; i != ordered_parts.size(); ++i) {
+        meshes[i].resize(rotation_sets[ordered_parts[i]->rotation_index].size());
+        for (std::size_t r = 0; r != meshes[i].size(); ++r) {
+            tasks.push_back({ i, r });
+        }
+    }
+
+    double progress = 0;
+    std::mutex progress_mutex{};
+    const auto add_progress = [&](const double amount) {
+        const std::lock_guard lock(progress_mutex);
+        progress += amount;
+        params.set_progress(progress, triangles);
+    };
+
+    std::optional<voxel_cache> cache{};
+    if (not params.voxel_cache.empty()) {
+        cache.emplace(params.voxel_cache);
+    }
+
+    std::vector<geo::matrix3<float>> base_rotations(ordered_parts.size(), geo::eye3<float>);
+    std::vector<std::shared_ptr<const mesh>> part_meshes(ordered_parts.size());
+    std::vector<mesh_arrays> part_arrays(ordered_parts.size());
+    std::vector<std::uint64_t> mesh_hashes(ordered_parts.size());
+    pool.for_each_index(ordered_parts.size(), [&](const std::size_t i) {
+        part_meshes[i] = std::make_shared<const mesh>(ordered_parts[i]->mesh);
+        part_arrays[i] = mesh_arrays(indexed_mesh(ordered_parts[i]->mesh));
+        if (cache) {
+            mesh_hashes[i] = voxel_cache::hash(ordered_parts[i]->mesh);
+        }
+        if (running and ordered_parts[i]->rotate_min_box) {
+            base_rotations[i] = min_box_rotation(ordered_parts[i]->mesh);
+        }
+    });
+    phases.min_box = std::chrono::nanoseconds(nanoseconds_since(phase_start));
+    phase_start = std::chrono::steady_clock::now();
+
+    // Calculate all the rotations
+    pool.for_each_index(tasks.size(), [&](const std::size_t task) {
+        if (not running) {
+            return;
+        }
+
+        const util::trace_scope trace("rotate");
+        const auto [i, r] = tasks[task];
+        const std::shared_ptr<const part> part = ordered_parts[i];
+        // Turned after the rotation to the minimum box, so that the box stays aligned with the axes
+        const auto total_rotation = rotation_sets[part->rotation_index][r] * base_rotations[i];
+        mesh_arrays m{};
+        const auto [min, max, box_size] = part_arrays[i].transform(scale_factor, total_rotation, { 0, 0, 0 }, m);
+        // The baseline is only known once the turned mesh is bounded, so moving onto it takes a second, lighter pass
+        const geo::vector3<float> offset = geo::origin3<float> - min;
+        m.translate(offset);
+        stack_result::piece piece = { .part = part, .part_mesh = part_meshes[i], .rotation = total_rotation, .translation = offset };
+        meshes[i][r] = { std::move(m), box_size, std::move(piece) };
+
+        add_progress(part->triangle_count / 2);
+    });
+    phases.rotation = std::chrono::nanoseconds(nanoseconds_since(phase_start));
+    if (not running) {
+        return std::nullopt;
+    }
+
+    // Track bounding box size
+    std::vector<geo::vector3<int>> max_box_sizes(ordered_parts.size(), { 1, 1, 1 });
+    for (std::size_t i = 0; i != ordered_parts.size(); ++i) {
+        for (const auto& [mesh, box_size, piece, voxels] : meshes[i]) {
+            max_box_sizes[i].x = std::max(box_size.x, max_box_sizes[i].x);
+            max_box_sizes[i].y = std::max(box_size.y, max_box_sizes[i].y);
+            max_box_sizes[i].z = std::max(box_size.z, max_box_sizes[i].z);
+        }
+    }
+
+    // Orientations that only swap and flip the axes of the first orientation of their part take its voxels the same way,
+    // rather than being voxelized. This covers every cubic rotation.
+    std::vector<std::size_t> voxelize_tasks{};
+    std::vector<std::pair<std::size_t, axis_permutation>> permute_tasks{};
+    for (std::size_t task = 0; task != tasks.size(); ++task) {
+        const auto [i, r] = tasks[task];
+        const auto rotations = rotation_sets[ordered_parts[i]->rotation_index];
+        const auto permutation = as_axis_permutation(rotations[r] * geo::transpose(rotations[0]));
+        if (r != 0 and permutation) {
+            permute_tasks.emplace_back(task, *permutation);
+        } else {
+            voxelize_tasks.push_back(task);
+        }
+    }
+
+    // Voxelize each rotated instance of each part
+    phase_start = std::chrono::steady_clock::now();
+    pool.for_each_index(voxelize_tasks.size(), [&](const std::size_t task) {
+        if (not running) {
+            return;
+        }
 
-                max_x = std::max(max_x, new_x + 2);
-                max_y = std::max(max_y, new_y + 2);
-                max_z = std::max(max_z, new_z + 2);
+        const auto [i, r] = tasks[voxelize_tasks[task]];
+        const std::shared_ptr<const part> part = ordered_parts[i];
+        auto& entry = meshes[i][r];
+
+        // Arbitrary rotations are drawn afresh every run, so they would never be found again
+        const bool cacheable = cache and rotation_sets[part->rotation_index].data() != arbitrary_rotations.data();
+        const voxel_key key{
+            .mesh_hash = mesh_hashes[i],
+            .triangle_count = part->mesh.triangles().size(),
+            .resolution = params.resolution,
+            .rotation = entry.piece.rotation,
+            .min_hole = part->min_hole,
+            .mirrored = part->mirrored,
+            .grid_size = max_box_sizes[i],
+        };
+        if (cacheable) {
+            const util::trace_scope trace("load_voxels");
+            if (auto voxels = cache->load(key)) {
+                entry.voxels = voxel_shape(std::move(*voxels));
+                statistics.allocate(entry.voxels.memory());
+                ++statistics.cached_orientations;
+                add_progress(part->triangle_count / 2);
+                return;
             }
         }
+
+        const auto [size_x, size_y, size_z] = max_box_sizes[i];
+        util::mdarray<int, 3> part_voxels(size_x, size_y, size_z);
+        const std::size_t row_words = (size_z + util::bit_grid::word_bits - 1) / util::bit_grid::word_bits;
+        const std::size_t voxelize_memory = part_voxels.size() * sizeof(int) + 3 * size_x * size_y * row_words * sizeof(util::bit_grid::word_type); // Along with the bit grids inside `voxelize`
+        statistics.allocate(voxelize_memory);
+        voxelize(entry.mesh, part_voxels, 1, part->min_hole);
+        util::bit_grid voxels = pack_voxels(part_voxels, 1);
+        if (cacheable) {
+            const util::trace_scope trace("store_voxels");
+            cache->store(key, voxels);
+        }
+        entry.voxels = voxel_shape(std::move(voxels));
+        statistics.allocate(entry.voxels.memory());
+        statistics.release(voxelize_memory);
+
+        add_progress(part->triangle_count / 2);
+    });
+    pool.for_each_index(permute_tasks.size(), [&](const std::size_t task) {
+        if (not running) {
+            return;
+        }
+
+        const auto& [index, permutation] = permute_tasks[task];
+        const auto [i, r] = tasks[index];
+        const auto& first = meshes[i][0];
+        auto& entry = meshes[i][r];
+        entry.voxels = voxel_shape(permute_voxels(first.voxels.voxels(), permutation));
+        statistics.allocate(entry.voxels.memory());
+
+        // Along a flipped axis, the mesh lies mirrored in the voxels, about the middle of the voxels spanned by the first
+        // orientation. Voxel `v` covers the mesh within `[v - 1.5, v + 0.5]`, so a flipped coordinate `t` ends up at
+        // `extent - 2 - t`, whereas rotating put it at `max - t`.
+        const geo::point3<float> first_max = first.mesh.bounding().max;
+        float shift[3] = {};
+        for (int a = 0; a != 3; ++a) {
+            const int b = permutation.source[a];
+            if (permutation.flipped[a]) {
+                const float max = b == 0 ? first_max.x : b == 1 ? first_max.y : first_max.z;
+                shift[a] = static_cast<float>(first.voxels.voxels().extent(b)) - 2 - max;
+            }
+        }
+        entry.piece.translation += entry.mesh.set_baseline({ shift[0], shift[1], shift[2] });
+
+        add_progress(ordered_parts[i]->triangle_count / 2);
+    });
+    phases.voxelization = std::chrono::nanoseconds(nanoseconds_since(phase_start));
+    if (not running) {
+        return std::nullopt;
+    }
+
+    int max_x = static_cast<int>(scale_factor * params.x_min);
+    int max_y = static_cast<int>(scale_factor * params.y_min);
+    int max_z = static_cast<int>(scale_factor * params.z_min);
+    const std::size_t space_x = std::max(max_x, static_cast<int>(scale_factor * params.x_max));
+    const std::size_t space_y = std::max(max_y, static_cast<int>(scale_factor * params.y_max));
+    const std::size_t space_z = std::max(max_z, static_cast<int>(scale_factor * params.z_max));
+
+    params.set_progress(0, 1);
+
+    // Every attempt packs the parts in its own order, and the smallest box wins, with ties going to the earlier attempt
+    const auto orders = part_orders(ordered_parts, max_box_sizes, params.attempts);
+    std::vector<std::optional<stack_state>> states(orders.size());
+    std::vector<pack_outcome> outcomes(orders.size());
+    std::vector<int> volumes(orders.size());
+    portfolio shared{ .total_parts = total_parts };
+    pool.for_each_index(orders.size(), [&](const std::size_t attempt) {
+        stack_state& state = states[attempt].emplace(stack_state{ .meshes = meshes, .statistics = statistics });
+        state.cursors.assign(ordered_parts.size(), {});
+        state.space = occupancy_grid(space_x, space_y, space_z);
+        statistics.allocate(state.space.memory());
+        outcomes[attempt] = pack(params, state, pool, ordered_parts, orders[attempt], { max_x, max_y, max_z }, shared, running);
+        volumes[attempt] = state.extents.x * state.extents.y * state.extents.z;
+    });
+
+    // Even when stopped, an attempt that has already finished is a complete stack
+    std::optional<std::size_t> best{};
+    for (std::size_t i = 0; i != outcomes.size(); ++i) {
+        if (outcomes[i] == pack_outcome::packed and not states[i]->placements.empty() and (not best.has_value() or volumes[i] < volumes[*best])) {
+            best = i;
+        }
+    }
+    if (not best.has_value()) {
+        if (not running) {
+            return std::nullopt;
+        }
+        return stack_result{};
     }
 
-    state.result.mesh.scale(1 / scale_factor);
-    return { std::move(state.result) };
+    if (params.improve_time > std::chrono::milliseconds::zero() and running) {
+        phase_start = std::chrono::steady_clock::now();
+        improve(params, *states[*best], pool, shared, running);
+        phases.improvement = std::chrono::nanoseconds(nanoseconds_since(phase_start));
+    }
+    stack_result result = assemble(*states[*best], 1 / scale_factor, pool);
+
+    result.statistics = phases;
+    result.statistics.placement = std::chrono::nanoseconds(statistics.placement);
+    result.statistics.enlargement = std::chrono::nanoseconds(statistics.enlargement);
+    result.statistics.can_place_calls = statistics.can_place_calls;
+    result.statistics.voxels_tested = statistics.voxels_tested;
+    result.statistics.early_rejections = statistics.early_rejections;
+    result.statistics.enlargement_rounds = statistics.enlargement_rounds;
+    result.statistics.cached_orientations = statistics.cached_orientations;
+    result.statistics.peak_grid_memory = statistics.peak_grid_memory;
+    return { std::move(result) };
 }
 
 } // namespace
 
-void stacker::stack(const stack_parameters params) {
-    if (_running.exchange(true)) {
-        return;
-    }
+void stack(const stack_parameters& params, const std::atomic<bool>& running) {
     const auto start = std::chrono::system_clock::now();
-    std::optional<stack_result> result = stack_impl(params, _running);
+    std::optional<stack_result> result = stack_impl(params, running);
     const auto elapsed = std::chrono::system_clock::now() - start;
     if (result.has_value()) {
         if (result->pieces.empty()) {
@@ -337,6 +949,67 @@ void stacker::stack(const stack_parameters params) {
         }
     }
     params.on_finish();
+}
+
+std::size_t estimate_memory(const stack_parameters& params) {
+    const double scale_factor = 1 / params.resolution;
+    const std::size_t attempts = std::max<std::size_t>(1, params.attempts);
+    const auto voxels = [&](const double size) {
+        return static_cast<std::size_t>(scale_factor * std::max(size, 0.0)) + 3;
+    };
+    const auto bit_grid_bytes = [](const std::size_t x, const std::size_t y, const std::size_t z) {
+        return x * y * (z + util::bit_grid::word_bits - 1) / util::bit_grid::word_bits * sizeof(util::bit_grid::word_type);
+    };
+
+    // The occupied space and heightmap of every attempt
+    const std::size_t space_x = voxels(std::max(params.x_min, params.x_max));
+    const std::size_t space_y = voxels(std::max(params.y_min, params.y_max));
+    const std::size_t space_z = voxels(std::max(params.z_min, params.z_max));
+    std::size_t out = attempts * (bit_grid_bytes(space_x, space_y, space_z) + space_x * space_y * sizeof(std::size_t));
+
+    for (const std::shared_ptr<const part>& part : params.parts) {
+        const std::size_t orientations = rotation_sets[part->rotation_index].size();
+        const std::size_t quantity = std::max(part->quantity, 0);
+
+        // The mesh kept for the pieces and the placed copies in the result, then the faces shared by every orientation and
+        // the vertices of each, along with those they're rotated from. A closed mesh has about half as many vertices as triangles.
+        out += (1 + quantity) * part->triangle_count * sizeof(geo::triangle);
+        out += part->triangle_count * sizeof(indexed_mesh::face);
+        out += (orientations + 1) * (part->triangle_count / 2 + 1) * sizeof(geo::point3<float>);
+
+        // Any rotation of the part fits in a cube as wide as its diagonal
+        const auto bounding = part->mesh.bounding();
+        const auto size = bounding.max - bounding.min;
+        const std::size_t side = voxels(std::sqrt(geo::dot(size, size)));
+        out += orientations * (bit_grid_bytes(side, side, side) + side * side * 2 * sizeof(std::size_t));
+        out += side * side * side * sizeof(int); // While voxelizing
+    }
+    return out;
+}
+
+void add_sinterbox(stack_result& result, const sinterbox_settings& settings) {
+    const double offset = settings.thickness + settings.clearance;
+    const auto bounding = result.mesh.bounding();
+    const auto shift = result.mesh.set_baseline(geo::origin3<float> + offset);
+    for (auto& piece : result.pieces) {
+        piece.translation += shift;
+    }
+    result.sinterbox = sinterbox_parameters{
+        .min = bounding.min + offset,
+        .max = bounding.max + offset,
+        .clearance = settings.clearance,
+        .thickness = settings.thickness,
+        .width = settings.width,
+        .spacing = settings.spacing + 0.00013759,
+    };
+    result.mesh.add_sinterbox(*result.sinterbox);
+}
+
+void stacker::stack(const stack_parameters params) {
+    if (_running.exchange(true)) {
+        return;
+    }
+    calc::stack(params, _running);
     _running = false;
 }
 
@@ -6,15 +6,37 @@
 #include "pstack/geo/vector3.hpp"
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <optional>
+#include <string>
 #include <vector>
 
 namespace pstack::calc {
 
+// Where the time of a stacking run went, and how much work it did
+struct stack_statistics {
+    std::chrono::nanoseconds min_box{};
+    std::chrono::nanoseconds rotation{};
+    std::chrono::nanoseconds voxelization{};
+    // Placement and enlargement are added up over all attempts, which may run at the same time
+    std::chrono::nanoseconds placement{};
+    std::chrono::nanoseconds enlargement{};
+    std::chrono::nanoseconds improvement{};
+
+    std::uint64_t can_place_calls = 0;
+    std::uint64_t voxels_tested = 0;
+    std::uint64_t early_rejections = 0; // Orientations ruled out by a probe voxel, without scanning the part
+    std::uint64_t enlargement_rounds = 0;
+    std::uint64_t cached_orientations = 0; // Loaded from `stack_parameters::voxel_cache` instead of voxelized
+    std::size_t peak_grid_memory = 0; // Bytes held by voxel grids at once
+};
+
 struct stack_result {
+    // Where a copy of a part ended up: `rotation * v + translation` for each vertex `v` of `part_mesh`
     struct piece {
         std::shared_ptr<const part> part;
+        std::shared_ptr<const calc::mesh> part_mesh; // As it was stacked, shared by every piece of the part
         geo::matrix3<float> rotation;
         geo::vector3<float> translation;
     };
@@ -24,13 +46,24 @@ struct stack_result {
     geo::vector3<float> size{};
     double density{};
     std::optional<sinterbox_parameters> sinterbox{};
+    stack_statistics statistics{};
+};
+
+// Moves the stack clear of a sinterbox, then adds one around it
+void add_sinterbox(stack_result& result, const sinterbox_settings& settings);
+
+// A change to the stack shown while stacking
+struct stack_preview {
+    mesh added;             // Triangles placed since the last preview, or the whole stack if `reset`
+    bool reset;             // Whether the triangles of earlier previews should be dropped
+    geo::vector3<int> box;  // Size of the box so far
 };
 
 struct stack_parameters {
     std::vector<std::shared_ptr<const part>> parts;
 
     std::function<void(double, double)> set_progress;
-    std::function<void(const mesh&, int, int, int)> display_mesh;
+    std::function<void(stack_preview)> display_preview; // May be left empty
     std::function<void(stack_result, std::chrono::system_clock::duration)> on_success;
     std::function<void()> on_failure;
     std::function<void()> on_finish;
@@ -39,8 +72,29 @@ struct stack_parameters {
     int x_min, x_max;
     int y_min, y_max;
     int z_min, z_max;
+
+    // Number of threads used for stacking, where zero means one per hardware thread
+    std::size_t threads = 0;
+
+    // Number of part orderings tried at once, keeping the one with the smallest box
+    std::size_t attempts = 1;
+
+    // Time spent after stacking trying to shrink the box, where zero skips it
+    std::chrono::milliseconds improve_time{};
+
+    // Shortest time between previews, so that showing them never holds up stacking
+    std::chrono::milliseconds preview_interval{ 100 };
+
+    // Directory where voxelized orientations are kept between runs, where empty turns the cache off
+    std::string voxel_cache{};
 };
 
+// Runs one stacking job on the calling thread, until it's done or `running` becomes false
+void stack(const stack_parameters& params, const std::atomic<bool>& running);
+
+// A rough upper bound on the memory in bytes that stacking with `params` takes
+std::size_t estimate_memory(const stack_parameters& params);
+
 class stacker {
 public:
     stacker()
@@ -56,6 +110,7 @@ public:
 
     void stack(stack_parameters params);
 
+    // Stops stacking. A complete stack that was already found is still reported as a success.
     void abort() {
         _running = false;
     }
@@ -0,0 +1,135 @@
+#include "pstack/calc/voxel_cache.hpp"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace pstack::calc {
+
+namespace {
+
+// Raised whenever the file layout or the voxels made for a key change, so that older files miss
+constexpr std::uint32_t format_version = 1;
+constexpr std::array<char, 8> magic = { 'P', 'S', 'V', 'O', 'X', 'E', 'L', 'S' };
+
+// Laid out so that the words after it are aligned, and the file could be mapped into memory as is.
+// Everything is in native byte order, and files from a machine with another byte order miss on `version`.
+struct file_header {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t word_bits;
+    voxel_key key;
+    std::array<std::uint64_t, 3> extents;
+    std::uint64_t checksum; // Of the words
+};
+
+static_assert(sizeof(file_header) == 128);
+
+constexpr std::uint64_t hash_basis = 0xcbf29ce484222325;
+constexpr std::uint64_t hash_prime = 0x100000001b3;
+
+// FNV-1a over 8 bytes at a time, so that large meshes hash at the speed of reading them
+std::uint64_t hash_bytes(const std::span<const std::byte> bytes, std::uint64_t hash = hash_basis) {
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= bytes.size(); i += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes.data() + i, sizeof(word));
+        hash = (hash ^ word) * hash_prime;
+        hash ^= hash >> 32; // Multiplying only carries upwards, so fold the high bits back down
+    }
+    for (; i != bytes.size(); ++i) {
+        hash = (hash ^ static_cast<std::uint64_t>(bytes[i])) * hash_prime;
+    }
+    return hash;
+}
+
+} // namespace
+
+voxel_cache::voxel_cache(std::filesystem::path directory)
+    : _directory(std::move(directory))
+{
+    std::error_code error;
+    std::filesystem::create_directories(_directory, error);
+}
+
+std::uint64_t voxel_cache::hash(const mesh& mesh) {
+    return hash_bytes(std::as_bytes(std::span(mesh.triangles())));
+}
+
+std::optional<util::bit_grid> voxel_cache::load(const voxel_key& key) const {
+    std::ifstream file(path(key), std::ios::binary);
+    file_header header;
+    if (not file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return std::nullopt;
+    }
+    if (header.magic != magic or header.version != format_version or header.word_bits != util::bit_grid::word_bits
+        or std::memcmp(&header.key, &key, sizeof(key)) != 0)
+    {
+        return std::nullopt;
+    }
+    // The voxels are trimmed to what the part occupies, so they never outgrow the grid they were made in
+    const auto [x, y, z] = header.extents;
+    if (x > static_cast<std::uint64_t>(key.grid_size.x) or y > static_cast<std::uint64_t>(key.grid_size.y) or z > static_cast<std::uint64_t>(key.grid_size.z)) {
+        return std::nullopt;
+    }
+
+    util::bit_grid voxels(x, y, z);
+    const auto words = voxels.words();
+    if (not file.read(reinterpret_cast<char*>(words.data()), words.size_bytes()) or file.peek() != std::ifstream::traits_type::eof()) {
+        return std::nullopt;
+    }
+    if (hash_bytes(std::as_bytes(words)) != header.checksum) {
+        return std::nullopt;
+    }
+    return voxels;
+}
+
+void voxel_cache::store(const voxel_key& key, const util::bit_grid& voxels) const {
+    const auto words = voxels.words();
+    const file_header header{
+        .magic = magic,
+        .version = format_version,
+        .word_bits = util::bit_grid::word_bits,
+        .key = key,
+        .extents = { voxels.extent(0), voxels.extent(1), voxels.extent(2) },
+        .checksum = hash_bytes(std::as_bytes(words)),
+    };
+
+    // Unique to this write, even between processes sharing the directory
+    const auto target = path(key);
+    auto temporary = target;
+    const auto clock = static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    temporary += "." + std::to_string(std::random_device{}() ^ clock) + ".tmp";
+
+    bool written = false;
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(words.data()), words.size_bytes());
+        file.close();
+        written = not file.fail();
+    }
+
+    std::error_code error;
+    if (written) {
+        std::filesystem::rename(temporary, target, error);
+    }
+    if (not written or error) {
+        std::filesystem::remove(temporary, error);
+    }
+}
+
+std::filesystem::path voxel_cache::path(const voxel_key& key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.voxels", static_cast<unsigned long long>(hash_bytes(std::as_bytes(std::span(&key, 1)))));
+    return _directory / name;
+}
+
+} // namespace pstack::calc
@@ -0,0 +1,53 @@
+#ifndef PSTACK_CALC_VOXEL_CACHE_HPP
+#define PSTACK_CALC_VOXEL_CACHE_HPP
+
+#include "pstack/calc/mesh.hpp"
+#include "pstack/geo/matrix3.hpp"
+#include "pstack/geo/vector3.hpp"
+#include "pstack/util/bit_grid.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <type_traits>
+
+namespace pstack::calc {
+
+// Everything that decides the voxels of one orientation of a part
+struct voxel_key {
+    std::uint64_t mesh_hash;
+    std::uint64_t triangle_count;
+    double resolution;
+    geo::matrix3<float> rotation; // Including the rotation to the minimum box
+    std::int32_t min_hole;
+    std::int32_t mirrored;
+    geo::vector3<int> grid_size;
+};
+
+static_assert(std::is_trivially_copyable_v<voxel_key> and sizeof(voxel_key) == 80, "Keys are hashed and stored as bytes, so they can't have padding");
+
+// Voxelized orientations of parts, kept on disk so that stacking the same parts again skips voxelizing them.
+// Each grid lives in its own file, named after the hash of its key, with the whole key in the header. A file that
+// doesn't match its key, or was cut short, is a miss. Files are written under a temporary name and then renamed,
+// so concurrent runs sharing a directory never see a half written grid.
+class voxel_cache {
+public:
+    // The directory is created if needed
+    explicit voxel_cache(std::filesystem::path directory);
+
+    // Meant to be worked out once per part, and shared by the keys of its orientations
+    static std::uint64_t hash(const mesh& mesh);
+
+    std::optional<util::bit_grid> load(const voxel_key& key) const;
+
+    // Failing to store only costs a later miss, so errors are ignored
+    void store(const voxel_key& key, const util::bit_grid& voxels) const;
+
+private:
+    std::filesystem::path path(const voxel_key& key) const;
+
+    std::filesystem::path _directory;
+};
+
+} // namespace pstack::calc
+
+#endif // PSTACK_CALC_VOXEL_CACHE_HPP
@@ -1,200 +1,458 @@
-#include "pstack/calc/bool.hpp"
 #include "pstack/calc/voxelize.hpp"
+#include "pstack/util/bit_grid.hpp"
 #include "pstack/util/mdarray.hpp"
+#include "pstack/util/trace.hpp"
 #include <algorithm>
-#include <cfenv>
+#include <bit>
 #include <cmath>
 #include <span>
-#include <stack>
+#include <utility>
 #include <vector>
 
 namespace pstack::calc {
 
-int voxelize(const mesh& mesh, const util::mdspan<int, 3> voxels, const int index, const std::size_t carver_size) {
-    util::mdarray<Bool, 3> actual_triangles(voxels.extents());
-    util::mdarray<Bool, 3> visited(voxels.extents());
-    util::mdarray<Bool, 3> carved(voxels.extents());
+namespace {
 
-    // First render each part, placing voxels at the position of each triangle
-    for (const geo::triangle& t : mesh.triangles()) {
-        const geo::vector3 a = t.v1.as_vector();
-        const geo::vector3 b = t.v2 - t.v1;
-        const geo::vector3 c = t.v3 - t.v1;
-
-        // Approximate the step size
-        const auto db = 0.1 / std::max({ std::abs(b.x), std::abs(b.y), std::abs(b.z) });
-        const auto dc = 0.1 / std::max({ std::abs(c.x), std::abs(c.y), std::abs(c.z) });
-
-        // Voxelize
-        for (float p = 0; p < 1; p += db) {
-            for (float q = 0; q < 1 - p; q += dc) {
-                const geo::vector3 pos = a + p * b + q * c;
-                // Round to the nearest integer
-                // This is a hot path, so `std::round()`, `std::nearbyint()`, `std::floor()` are much slower
-                const auto x = static_cast<std::size_t>(pos.x + 0.5f);
-                const auto y = static_cast<std::size_t>(pos.y + 0.5f);
-                const auto z = static_cast<std::size_t>(pos.z + 0.5f);
-                actual_triangles[x, y, z] = true;
-            }
-        }
+using vector3 = geo::vector3<float>;
+
+float along(const vector3& v, const int axis) {
+    return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+}
+
+// Whether the triangle `a, b, c` touches the unit cube centred on the origin, by the separating axis test of Akenine-Moller.
+// The faces of the cube aren't tested, since only cubes overlapping the bounding box of the triangle are ever visited.
+bool touches_unit_cube(const vector3 a, const vector3 b, const vector3 c, const vector3 normal) {
+    const auto reach = [](const vector3 axis) {
+        return 0.5f * (std::abs(axis.x) + std::abs(axis.y) + std::abs(axis.z));
+    };
+
+    // The plane of the triangle
+    if (std::abs(geo::dot(normal, a)) > reach(normal)) {
+        return false;
     }
 
-    if (carver_size > 0) {
-        std::stack<geo::point3<int>> stack{};
-
-        // Carving step
-        for (int x = 0; x < voxels.extent(0); ++x) {
-            for (int y = 0; y < voxels.extent(1); ++y) {
-                for (int z = 0; z < voxels.extent(2); ++z) {
-                    if (x == 0 || y == 0 || z == 0 || x == voxels.extent(0) - carver_size || y == voxels.extent(1) - carver_size || z == voxels.extent(2) - carver_size) {
-#if defined(__cpp_aggregate_paren_init) and __cpp_aggregate_paren_init >= 201902L
-                        stack.emplace(x, y, z);
-#else
-                        stack.push(geo::point3<int>{x, y, z});
-#endif
-                    }
-                }
+    // Each edge crossed with each axis of the cube
+    for (const vector3 edge : { b - a, c - b, a - c }) {
+        for (const vector3 axis : { vector3{ 0, -edge.z, edge.y }, vector3{ edge.z, 0, -edge.x }, vector3{ -edge.y, edge.x, 0 } }) {
+            const float pa = geo::dot(axis, a);
+            const float pb = geo::dot(axis, b);
+            const float pc = geo::dot(axis, c);
+            const float r = reach(axis);
+            if (std::min({ pa, pb, pc }) > r or std::max({ pa, pb, pc }) < -r) {
+                return false;
             }
         }
+    }
+    return true;
+}
 
-        while (not stack.empty()) {
-            const auto [x, y, z] = stack.top();
-            stack.pop();
+// Marks every voxel the triangle touches, where voxel `i` spans `[i - 0.5, i + 0.5]` along each axis.
+// Columns are walked along the axis the triangle faces most, so each column only holds a voxel or two to test.
+void rasterize(const geo::triangle& t, util::bit_grid& voxels) {
+    const vector3 a = t.v1.as_vector();
+    const vector3 b = t.v2.as_vector();
+    const vector3 c = t.v3.as_vector();
 
-            // Check if we need to do work here
-            if (x < 0 || y < 0 || z < 0 || x > voxels.extent(0) - carver_size || y > voxels.extent(1) - carver_size || z > voxels.extent(2) - carver_size || visited[x, y, z]) {
-                continue;
-            }
-            visited[x, y, z] = true;
-
-            const bool good = [&] {
-                for (std::size_t i = 0; i < carver_size; ++i) {
-                    for (std::size_t j = 0; j < carver_size; ++j) {
-                        for (std::size_t k = 0; k < carver_size; ++k) {
-                            if (actual_triangles[x + i, y + j, z + k]) {
-                                return false;
-                            }
-                        }
-                    }
+    // The voxels under the bounding box, rounded the same way as a single point
+    int lo[3];
+    int hi[3];
+    for (int axis = 0; axis != 3; ++axis) {
+        const auto cell = [&](const float coordinate) {
+            return std::clamp(static_cast<int>(std::floor(coordinate + 0.5f)), 0, static_cast<int>(voxels.extent(axis)) - 1);
+        };
+        lo[axis] = cell(std::min({ along(a, axis), along(b, axis), along(c, axis) }));
+        hi[axis] = cell(std::max({ along(a, axis), along(b, axis), along(c, axis) }));
+    }
+
+    // Detailed parts are mostly made of triangles within a single voxel
+    if (lo[0] == hi[0] and lo[1] == hi[1] and lo[2] == hi[2]) {
+        voxels.set(lo[0], lo[1], lo[2]);
+        return;
+    }
+
+    const vector3 normal = geo::cross(b - a, c - a);
+    const auto test = [&](const int x, const int y, const int z) {
+        const vector3 centre = { (float)x, (float)y, (float)z };
+        if (not voxels.test(x, y, z) and touches_unit_cube(a - centre, b - centre, c - centre, normal)) {
+            voxels.set(x, y, z);
+        }
+    };
+
+    int d = 0;
+    for (int axis = 1; axis != 3; ++axis) {
+        if (std::abs(along(normal, axis)) > std::abs(along(normal, d))) {
+            d = axis;
+        }
+    }
+    const float nd = along(normal, d);
+    int cell[3];
+    if (nd == 0) {
+        // A degenerate triangle has no plane to walk along
+        for (cell[0] = lo[0]; cell[0] <= hi[0]; ++cell[0]) {
+            for (cell[1] = lo[1]; cell[1] <= hi[1]; ++cell[1]) {
+                for (cell[2] = lo[2]; cell[2] <= hi[2]; ++cell[2]) {
+                    test(cell[0], cell[1], cell[2]);
                 }
-                return true;
-            }();
-            if (not good) {
-                continue;
             }
+        }
+        return;
+    }
 
-            for (std::size_t i = 0; i < carver_size; ++i) {
-                for (std::size_t j = 0; j < carver_size; ++j) {
-                    for (std::size_t k = 0; k < carver_size; ++k) {
-                        carved[x + i, y + j, z + k] = true;
-                    }
-                }
+    const int u = (d + 1) % 3;
+    const int w = (d + 2) % 3;
+    const float nu = along(normal, u);
+    const float nw = along(normal, w);
+    const float offset = geo::dot(normal, a);
+    const float spread = 0.5f * (std::abs(nu) + std::abs(nw)) / std::abs(nd); // Of the plane across one column
+    for (cell[u] = lo[u]; cell[u] <= hi[u]; ++cell[u]) {
+        for (cell[w] = lo[w]; cell[w] <= hi[w]; ++cell[w]) {
+            const float depth = (offset - nu * cell[u] - nw * cell[w]) / nd;
+            const int first = std::max(lo[d], static_cast<int>(std::floor(depth - spread + 0.5f)));
+            const int last = std::min(hi[d], static_cast<int>(std::floor(depth + spread + 0.5f)));
+            for (cell[d] = first; cell[d] <= last; ++cell[d]) {
+                test(cell[0], cell[1], cell[2]);
             }
+        }
+    }
+}
 
-#if defined(__cpp_aggregate_paren_init) and __cpp_aggregate_paren_init >= 201902L
-            stack.emplace(x - 1, y, z);
-            stack.emplace(x + 1, y, z);
+// Morphology works on whole rows of a `util::bit_grid` at once, so the z axis is handled 64 voxels at a time
 
-            stack.emplace(x, y - 1, z);
-            stack.emplace(x, y + 1, z);
+using word = util::bit_grid::word_type;
+constexpr std::size_t word_bits = util::bit_grid::word_bits;
 
-            stack.emplace(x, y, z - 1);
-            stack.emplace(x, y, z + 1);
-#else
-            stack.push(geo::point3<int>{x - 1, y, z});
-            stack.push(geo::point3<int>{x + 1, y, z});
+// Moves the bits of `in` by `shift` towards higher z, dropping any that pass the end of the row's words
+void shift_up(const std::span<const word> in, const std::span<word> out, const std::size_t shift) {
+    const std::size_t words = shift / word_bits;
+    const std::size_t bits = shift % word_bits;
+    for (std::size_t i = out.size(); i-- != 0;) {
+        word w = (i >= words) ? in[i - words] << bits : 0;
+        if (bits != 0 and i >= words + 1) {
+            w |= in[i - words - 1] >> (word_bits - bits);
+        }
+        out[i] = w;
+    }
+}
 
-            stack.push(geo::point3<int>{x, y - 1, z});
-            stack.push(geo::point3<int>{x, y + 1, z});
+// Moves the bits of `in` by `shift` towards lower z
+void shift_down(const std::span<const word> in, const std::span<word> out, const std::size_t shift) {
+    const std::size_t words = shift / word_bits;
+    const std::size_t bits = shift % word_bits;
+    for (std::size_t i = 0; i != out.size(); ++i) {
+        word w = (i + words < in.size()) ? in[i + words] >> bits : 0;
+        if (bits != 0 and i + words + 1 < in.size()) {
+            w |= in[i + words + 1] << (word_bits - bits);
+        }
+        out[i] = w;
+    }
+}
 
-            stack.push(geo::point3<int>{x, y, z - 1});
-            stack.push(geo::point3<int>{x, y, z + 1});
-#endif
+// Sets the bits in `[begin, end)`
+void set_range(const std::span<word> row, const std::size_t begin, const std::size_t end) {
+    for (std::size_t z = begin; z < end;) {
+        const std::size_t count = std::min(end - z, word_bits - z % word_bits);
+        const word ones = count == word_bits ? ~word{} : ((word{1} << count) - 1);
+        row[z / word_bits] |= ones << (z % word_bits);
+        z += count;
+    }
+}
+
+// Whether any bit in `[begin, end)` is set
+bool any_in_range(const std::span<const word> row, const std::size_t begin, const std::size_t end) {
+    for (std::size_t z = begin; z < end;) {
+        const std::size_t count = std::min(end - z, word_bits - z % word_bits);
+        const word ones = count == word_bits ? ~word{} : ((word{1} << count) - 1);
+        if (((row[z / word_bits] >> (z % word_bits)) & ones) != 0) {
+            return true;
         }
+        z += count;
+    }
+    return false;
+}
 
-        // #region convexivy
+// The first bit at or after `z` that equals `value`, or `end` if there is none before it
+std::size_t find_bit(const std::span<const word> row, std::size_t z, const std::size_t end, const bool value) {
+    while (z < end) {
+        const word w = (value ? row[z / word_bits] : ~row[z / word_bits]) >> (z % word_bits);
+        if (w != 0) {
+            return std::min(end, z + std::countr_zero(w));
+        }
+        z = (z / word_bits + 1) * word_bits;
+    }
+    return end;
+}
 
-        // Make convex in z-direction
-        for (int x = 0; x < voxels.extent(0); ++x) {
-            for (int y = 0; y < voxels.extent(1); ++y) {
-                int minV = std::numeric_limits<int>::max();
-                int maxV = std::numeric_limits<int>::min();
+// Grows `reached` to the whole of every run of `open` bits that it touches
+void fill_runs(const std::span<const word> open, const std::span<word> reached, const std::size_t size) {
+    for (std::size_t z = find_bit(open, 0, size, true); z != size; z = find_bit(open, z, size, true)) {
+        const std::size_t end = find_bit(open, z, size, false);
+        if (any_in_range(reached, z, end)) {
+            set_range(reached, z, end);
+        }
+        z = end;
+    }
+}
 
-                for (int z = 0; z < voxels.extent(2); ++z) {
-                    if (actual_triangles[x, y, z]) {
-                        minV = std::min(z, minV);
-                        maxV = std::max(z, maxV);
-                    }
+// ORs each row into the `length - 1` rows before it (`forward == false`) or after it (`forward == true`), along x or y.
+// Doubling the span covered each round takes `log2(length)` passes, and each pass can run in place.
+void spread_rows(util::bit_grid& grid, const int axis, const std::size_t length, const bool forward) {
+    const std::size_t lines = grid.extent(axis);
+    const std::size_t across = grid.extent(1 - axis);
+    const auto row = [&](const std::size_t line, const std::size_t other) {
+        return axis == 0 ? grid.row(line, other) : grid.row(other, line);
+    };
+    for (std::size_t span = 1; span < length;) {
+        const std::size_t step = std::min(span, length - span);
+        for (std::size_t other = 0; other != across; ++other) {
+            for (std::size_t n = 0; n + step < lines; ++n) {
+                // Visit rows in the order that reads each source row before it's changed
+                const std::size_t line = forward ? lines - 1 - n : n;
+                const auto target = row(line, other);
+                const auto source = row(forward ? line - step : line + step, other);
+                for (std::size_t i = 0; i != target.size(); ++i) {
+                    target[i] |= source[i];
                 }
+            }
+        }
+        span += step;
+    }
+}
 
-                for (int z = minV; z < maxV; z++) {
-                    actual_triangles[x, y, z] = true;
+// The same along z, within each row
+void spread_bits(util::bit_grid& grid, const std::size_t length, const bool forward) {
+    std::vector<word> shifted(grid.row_words());
+    std::vector<word> valid(grid.row_words());
+    set_range(valid, 0, grid.extent(2));
+    for (std::size_t x = 0; x != grid.extent(0); ++x) {
+        for (std::size_t y = 0; y != grid.extent(1); ++y) {
+            const auto row = grid.row(x, y);
+            for (std::size_t span = 1; span < length;) {
+                const std::size_t step = std::min(span, length - span);
+                if (forward) {
+                    shift_up(row, shifted, step);
+                } else {
+                    shift_down(row, shifted, step);
                 }
+                for (std::size_t i = 0; i != row.size(); ++i) {
+                    row[i] |= shifted[i] & valid[i];
+                }
+                span += step;
             }
         }
+    }
+}
+
+// The voxels cleared by sweeping a cube of `size` voxels in from the outside of the grid, without it touching `surface`.
+// Cubes are tracked by their lowest corner: those clear of `surface` are found by spreading `surface` back over each cube,
+// the ones reachable from the outside are flood filled a row at a time, then spread forward over their cubes again.
+util::bit_grid carve(const util::bit_grid& surface, const std::size_t size) {
+    const std::size_t extent_x = surface.extent(0);
+    const std::size_t extent_y = surface.extent(1);
+    const std::size_t extent_z = surface.extent(2);
+    util::bit_grid reached(extent_x, extent_y, extent_z);
+    if (size > extent_x or size > extent_y or size > extent_z) {
+        return reached;
+    }
+    const std::size_t last_x = extent_x - size;
+    const std::size_t last_y = extent_y - size;
+    const std::size_t last_z = extent_z - size;
+
+    // Corners whose cube holds part of the surface
+    util::bit_grid blocked = surface;
+    spread_bits(blocked, size, false);
+    spread_rows(blocked, 1, size, false);
+    spread_rows(blocked, 0, size, false);
+
+    std::vector<word> corners(surface.row_words());
+    set_range(corners, 0, last_z + 1);
+    std::vector<word> ends(surface.row_words());
+    ends[0] |= 1;
+    ends[last_z / word_bits] |= word{1} << (last_z % word_bits);
 
-        // Make convex in y-direction
-        for (int x = 0; x < voxels.extent(0); ++x) {
-            for (int z = 0; z < voxels.extent(2); ++z) {
-                int minV = std::numeric_limits<int>::max();
-                int maxV = std::numeric_limits<int>::min();
+    std::vector<word> open(surface.row_words());
+    std::vector<word> grown(surface.row_words());
+    std::vector<std::pair<std::size_t, std::size_t>> pending{};
 
-                for (int y = 0; y < voxels.extent(1); ++y) {
-                    if (actual_triangles[x, y, z]) {
-                        minV = std::min(y, minV);
-                        maxV = std::max(y, maxV);
-                    }
+    // Adds the open corners of row (x, y) that `seeds` touches, and everything along the row connected to them
+    const auto visit = [&](const std::size_t x, const std::size_t y, const std::span<const word> seeds) {
+        const auto row = reached.row(x, y);
+        const auto walls = blocked.row(x, y);
+        bool grew = false;
+        for (std::size_t i = 0; i != row.size(); ++i) {
+            open[i] = corners[i] & ~walls[i];
+            grown[i] = seeds[i] & open[i] & ~row[i];
+            grew = grew or grown[i] != 0;
+        }
+        if (not grew) {
+            return;
+        }
+        for (std::size_t i = 0; i != row.size(); ++i) {
+            grown[i] |= row[i];
+        }
+        fill_runs(open, grown, last_z + 1);
+        std::ranges::copy(grown, row.begin());
+        pending.emplace_back(x, y);
+    };
+
+    // Start from every corner on the outside
+    for (std::size_t x = 0; x <= last_x; ++x) {
+        for (std::size_t y = 0; y <= last_y; ++y) {
+            const bool side = x == 0 or y == 0 or x == last_x or y == last_y;
+            visit(x, y, side ? corners : ends);
+        }
+    }
+    std::vector<word> from(surface.row_words());
+    while (not pending.empty()) {
+        const auto [x, y] = pending.back();
+        pending.pop_back();
+        std::ranges::copy(reached.row(x, y), from.begin());
+        if (x > 0) {
+            visit(x - 1, y, from);
+        }
+        if (x < last_x) {
+            visit(x + 1, y, from);
+        }
+        if (y > 0) {
+            visit(x, y - 1, from);
+        }
+        if (y < last_y) {
+            visit(x, y + 1, from);
+        }
+    }
+
+    spread_bits(reached, size, true);
+    spread_rows(reached, 1, size, true);
+    spread_rows(reached, 0, size, true);
+    return reached;
+}
+
+// Fills the gap between the first and last voxel of every line along z, then y, then x
+void convexify(util::bit_grid& grid) {
+    const std::size_t extent_z = grid.extent(2);
+    for (std::size_t x = 0; x != grid.extent(0); ++x) {
+        for (std::size_t y = 0; y != grid.extent(1); ++y) {
+            const auto row = grid.row(x, y);
+            const std::size_t first = find_bit(row, 0, extent_z, true);
+            for (std::size_t i = row.size(); i-- != 0;) {
+                if (row[i] != 0) {
+                    set_range(row, first, i * word_bits + word_bits - 1 - std::countl_zero(row[i]));
+                    break;
                 }
+            }
+        }
+    }
 
-                for (int y = minV; y < maxV; y++) {
-                    actual_triangles[x, y, z] = true;
+    // Along x and y, a voxel is between the first and last of its line when some voxel is set both before and after it.
+    // Both are gathered a row at a time, with the running OR from the front kept in `before`.
+    util::bit_grid before(grid.extent(0), grid.extent(1), extent_z);
+    std::vector<word> after(grid.row_words());
+    for (const int axis : { 1, 0 }) {
+        const std::size_t lines = grid.extent(axis);
+        const auto row = [&](util::bit_grid& g, const std::size_t line, const std::size_t other) {
+            return axis == 0 ? g.row(line, other) : g.row(other, line);
+        };
+        for (std::size_t other = 0; other != grid.extent(1 - axis); ++other) {
+            std::ranges::copy(row(grid, 0, other), row(before, 0, other).begin());
+            for (std::size_t line = 1; line != lines; ++line) {
+                const auto target = row(before, line, other);
+                const auto source = row(grid, line, other);
+                const auto previous = row(before, line - 1, other);
+                for (std::size_t i = 0; i != target.size(); ++i) {
+                    target[i] = source[i] | previous[i];
+                }
+            }
+            std::ranges::fill(after, 0);
+            for (std::size_t line = lines; line-- != 0;) {
+                const auto target = row(grid, line, other);
+                const auto front = row(before, line, other);
+                for (std::size_t i = 0; i != target.size(); ++i) {
+                    after[i] |= target[i];
+                    target[i] = front[i] & after[i];
                 }
             }
         }
+    }
+}
 
-        // Make convex in x-direction
-        for (int z = 0; z < voxels.extent(2); ++z) {
-            for (int y = 0; y < voxels.extent(1); ++y) {
-                int minV = std::numeric_limits<int>::max();
-                int maxV = std::numeric_limits<int>::min();
+// Everything after rendering the triangles, which doesn't depend on how the mesh is stored
+int fill(util::bit_grid& actual_triangles, const util::mdspan<int, 3> voxels, const int index, const std::size_t carver_size) {
+    const std::size_t extent_x = voxels.extent(0);
+    const std::size_t extent_y = voxels.extent(1);
+    const std::size_t extent_z = voxels.extent(2);
+    util::bit_grid carved{};
 
-                for (int x = 0; x < voxels.extent(0); ++x) {
-                    if (actual_triangles[x, y, z]) {
-                        minV = std::min(x, minV);
-                        maxV = std::max(x, maxV);
-                    }
-                }
+    if (carver_size > 0) {
+        carved = carve(actual_triangles, carver_size);
+        convexify(actual_triangles);
+    }
 
-                for (int x = minV; x < maxV; x++) {
-                    actual_triangles[x, y, z] = true;
+    // Expand by one voxel in all directions, towards higher coordinates. Voxels on the last layer of each axis don't expand,
+    // and a voxel only keeps itself if a neighbour expands into it.
+    const std::size_t row_words = actual_triangles.row_words();
+    std::vector<word> inner(row_words);
+    if (extent_z > 1) {
+        set_range(inner, 0, extent_z - 1);
+    }
+    for (std::size_t x = 0; x != extent_x; ++x) {
+        for (std::size_t y = 0; y != extent_y; ++y) {
+            const auto row = actual_triangles.row(x, y);
+            if (x + 1 == extent_x or y + 1 == extent_y) {
+                std::ranges::fill(row, 0);
+                continue;
+            }
+            for (std::size_t i = 0; i != row_words; ++i) {
+                row[i] &= inner[i];
+            }
+            if (carver_size > 0) {
+                const auto cut = carved.row(x, y);
+                for (std::size_t i = 0; i != row_words; ++i) {
+                    row[i] &= ~cut[i];
                 }
             }
         }
+    }
 
-        // #endregion
+    // Each row, along with itself moved one voxel along z
+    util::bit_grid thick(extent_x, extent_y, extent_z);
+    std::vector<word> shifted(row_words);
+    for (std::size_t x = 0; x != extent_x; ++x) {
+        for (std::size_t y = 0; y != extent_y; ++y) {
+            const auto row = actual_triangles.row(x, y);
+            shift_up(row, shifted, 1);
+            const auto out = thick.row(x, y);
+            for (std::size_t i = 0; i != row_words; ++i) {
+                out[i] = row[i] | shifted[i];
+            }
+        }
     }
 
-    // Expand by one voxel in all directions
-    for (std::size_t x = 0; x < voxels.extent(0) - 1; ++x) {
-        for (std::size_t y = 0; y < voxels.extent(1) - 1; ++y) {
-            for (std::size_t z = 0; z < voxels.extent(2) - 1; ++z) {
-                if (not carved[x, y, z] and actual_triangles[x, y, z]) {
+    std::vector<word> expanded(row_words);
+    for (std::size_t x = 0; x != extent_x; ++x) {
+        for (std::size_t y = 0; y != extent_y; ++y) {
+            shift_up(actual_triangles.row(x, y), expanded, 1);
+            const auto add = [&](const std::size_t from_x, const std::size_t from_y) {
+                const auto from = thick.row(from_x, from_y);
+                for (std::size_t i = 0; i != row_words; ++i) {
+                    expanded[i] |= from[i];
+                }
+            };
+            if (y > 0) {
+                add(x, y - 1);
+            }
+            if (x > 0) {
+                add(x - 1, y);
+                if (y > 0) {
+                    add(x - 1, y - 1);
+                }
+            }
+
+            for (std::size_t i = 0; i != row_words; ++i) {
+                for (word bits = expanded[i]; bits != 0; bits &= bits - 1) {
+                    const std::size_t z = i * word_bits + std::countr_zero(bits);
 #if defined(MDSPAN_USE_BRACKET_OPERATOR) and MDSPAN_USE_BRACKET_OPERATOR == 0
-                    voxels(x + 1, y + 1, z + 1) |= index;
-                    voxels(x + 1, y + 1, z) |= index;
-                    voxels(x + 1, y, z + 1) |= index;
-                    voxels(x + 1, y, z) |= index;
-                    voxels(x, y + 1, z) |= index;
-                    voxels(x, y + 1, z + 1) |= index;
-                    voxels(x, y, z + 1) |= index;
+                    voxels(x, y, z) |= index;
 #else
-                    voxels[x + 1, y + 1, z + 1] |= index;
-                    voxels[x + 1, y + 1, z] |= index;
-                    voxels[x + 1, y, z + 1] |= index;
-                    voxels[x + 1, y, z] |= index;
-                    voxels[x, y + 1, z] |= index;
-                    voxels[x, y + 1, z + 1] |= index;
-                    voxels[x, y, z + 1] |= index;
+                    voxels[x, y, z] |= index;
 #endif
                 }
             }
@@ -208,4 +466,28 @@ int voxelize(const mesh& mesh, const util::mdspan<int, 3> voxels, const int inde
     });
 }
 
+} // namespace
+
+int voxelize(const mesh& mesh, const util::mdspan<int, 3> voxels, const int index, const std::size_t carver_size) {
+    const util::trace_scope trace("voxelize");
+    util::bit_grid actual_triangles(voxels.extent(0), voxels.extent(1), voxels.extent(2));
+
+    // First render each part, placing voxels wherever a triangle touches
+    for (const geo::triangle& t : mesh.triangles()) {
+        rasterize(t, actual_triangles);
+    }
+    return fill(actual_triangles, voxels, index, carver_size);
+}
+
+int voxelize(const mesh_arrays& mesh, const util::mdspan<int, 3> voxels, const int index, const std::size_t carver_size) {
+    const util::trace_scope trace("voxelize");
+    util::bit_grid actual_triangles(voxels.extent(0), voxels.extent(1), voxels.extent(2));
+    for (std::size_t i = 0; i != mesh.size(); ++i) {
+        // Rendering only needs the corners, which saves working out the normal
+        const auto [v1, v2, v3] = mesh.corners(i);
+        rasterize({ .normal = {}, .v1 = v1, .v2 = v2, .v3 = v3 }, actual_triangles);
+    }
+    return fill(actual_triangles, voxels, index, carver_size);
+}
+
 } // namespace pstack::calc
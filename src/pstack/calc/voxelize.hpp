@@ -2,11 +2,13 @@
 #define PSTACK_CALC_VOXELIZE_HPP
 
 #include "pstack/calc/mesh.hpp"
+#include "pstack/calc/mesh_arrays.hpp"
 #include "pstack/util/mdarray.hpp"
 
 namespace pstack::calc {
 
 int voxelize(const mesh& mesh, util::mdspan<int, 3> voxels, int index, std::size_t carver_size);
+int voxelize(const mesh_arrays& mesh, util::mdspan<int, 3> voxels, int index, std::size_t carver_size);
 
 } // namespace pstack::calc
 
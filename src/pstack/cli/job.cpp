@@ -0,0 +1,172 @@
+#include "pstack/cli/job.hpp"
+#include "pstack/files/stl.hpp"
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace pstack::cli {
+
+namespace {
+
+calc::part load_part(const std::string& mesh_file) {
+    calc::part part;
+    part.mesh_file = mesh_file;
+    part.name = std::filesystem::path(part.mesh_file).stem().string();
+    part.mesh = files::from_stl(part.mesh_file);
+    if (part.mesh.triangles().empty()) {
+        throw std::runtime_error("Could not read any triangles from " + mesh_file);
+    }
+    part.mesh.set_baseline({ 0, 0, 0 });
+
+    part.base_quantity = std::nullopt;
+    part.quantity = 1;
+
+    auto volume_and_centroid = part.mesh.volume_and_centroid();
+    part.volume = volume_and_centroid.volume;
+    part.centroid = volume_and_centroid.centroid;
+    part.triangle_count = part.mesh.triangles().size();
+    part.mirrored = false;
+    part.min_hole = 1;
+    part.rotation_index = 1;
+    part.rotate_min_box = false;
+    return part;
+}
+
+// Reads all of `values` from the rest of the line, and returns whether they were all there and nothing else was
+template <class... Ts>
+bool read_values(std::istringstream& line, Ts&... values) {
+    (line >> ... >> values);
+    return not line.fail() and (line >> std::ws).eof();
+}
+
+std::string read_path(std::istringstream& line) {
+    std::string path{};
+    std::getline(line >> std::ws, path);
+    while (not path.empty() and std::isspace(static_cast<unsigned char>(path.back()))) {
+        path.pop_back();
+    }
+    return path;
+}
+
+} // namespace
+
+job read_job(const std::string& file_path) {
+    std::ifstream file(file_path);
+    if (not file.is_open()) {
+        throw std::runtime_error("Could not open " + file_path);
+    }
+
+    const std::filesystem::path directory = std::filesystem::path(file_path).parent_path();
+    const auto resolve = [&](const std::string& path) {
+        return (directory / path).string();
+    };
+
+    job out{};
+    out.output = std::filesystem::path(file_path).replace_extension(".stl").string();
+
+    std::size_t line_number = 0;
+    for (std::string text{}; std::getline(file, text); ) {
+        ++line_number;
+        const auto error = [&](const std::string& message) {
+            return std::runtime_error(file_path + ":" + std::to_string(line_number) + ": " + message);
+        };
+
+        std::istringstream line(text);
+        std::string key{};
+        if (not (line >> key) or key.starts_with('#')) {
+            continue;
+        }
+
+        const auto current_part = [&]() -> calc::part& {
+            if (out.parts.empty()) {
+                throw error("\"" + key + "\" must come after a part");
+            }
+            return out.parts.back();
+        };
+
+        if (key == "part") {
+            const std::string path = read_path(line);
+            if (path.empty()) {
+                throw error("Expected a file path");
+            }
+            out.parts.push_back(load_part(resolve(path)));
+        } else if (key == "quantity") {
+            calc::part& part = current_part();
+            if (not read_values(line, part.quantity) or part.quantity < 0) {
+                throw error("Expected a quantity of zero or more");
+            }
+        } else if (key == "rotations") {
+            calc::part& part = current_part();
+            std::string name{};
+            read_values(line, name);
+            if (name == "none") {
+                part.rotation_index = 0;
+            } else if (name == "cubic") {
+                part.rotation_index = 1;
+            } else if (name == "arbitrary") {
+                part.rotation_index = 2;
+            } else {
+                throw error("Expected one of none, cubic, or arbitrary");
+            }
+        } else if (key == "min_hole") {
+            calc::part& part = current_part();
+            if (not read_values(line, part.min_hole) or part.min_hole < 0) {
+                throw error("Expected a hole size of zero or more");
+            }
+        } else if (key == "minimize") {
+            current_part().rotate_min_box = true;
+        } else if (key == "mirror") {
+            calc::part& part = current_part();
+            part.mirrored = not part.mirrored;
+            part.mesh.mirror_x();
+        } else if (key == "resolution") {
+            if (not read_values(line, out.resolution) or out.resolution <= 0) {
+                throw error("Expected a positive resolution");
+            }
+        } else if (key == "initial") {
+            if (not read_values(line, out.x_min, out.y_min, out.z_min)) {
+                throw error("Expected three sizes");
+            }
+        } else if (key == "maximum") {
+            if (not read_values(line, out.x_max, out.y_max, out.z_max)) {
+                throw error("Expected three sizes");
+            }
+        } else if (key == "sinterbox") {
+            auto& sinterbox = out.sinterbox.emplace();
+            if (not (line >> std::ws).eof() and not read_values(line, sinterbox.clearance, sinterbox.spacing, sinterbox.thickness, sinterbox.width)) {
+                throw error("Expected a clearance, spacing, thickness, and width");
+            }
+        } else if (key == "threads") {
+            if (not read_values(line, out.threads)) {
+                throw error("Expected a thread count");
+            }
+        } else if (key == "attempts") {
+            if (not read_values(line, out.attempts)) {
+                throw error("Expected an attempt count");
+            }
+        } else if (key == "improve") {
+            double seconds = 0;
+            if (not read_values(line, seconds) or seconds < 0) {
+                throw error("Expected a number of seconds");
+            }
+            out.improve_time = std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(seconds * 1000));
+        } else if (key == "output") {
+            const std::string path = read_path(line);
+            if (path.empty()) {
+                throw error("Expected a file path");
+            }
+            out.output = resolve(path);
+        } else {
+            throw error("Unknown setting \"" + key + "\"");
+        }
+    }
+
+    if (out.parts.empty()) {
+        throw std::runtime_error(file_path + ": No parts to stack");
+    }
+    return out;
+}
+
+} // namespace pstack::cli
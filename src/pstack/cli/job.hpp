@@ -0,0 +1,53 @@
+#ifndef PSTACK_CLI_JOB_HPP
+#define PSTACK_CLI_JOB_HPP
+
+#include "pstack/calc/part.hpp"
+#include "pstack/calc/sinterbox.hpp"
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace pstack::cli {
+
+// Everything needed to stack one plate, with the same defaults as the GUI
+struct job {
+    std::vector<calc::part> parts{};
+
+    double resolution = 1;
+    int x_min = 150, x_max = 156;
+    int y_min = 150, y_max = 156;
+    int z_min = 30, z_max = 90;
+    std::optional<calc::sinterbox_settings> sinterbox{};
+
+    std::size_t threads = 0;
+    std::size_t attempts = 1;
+    std::chrono::milliseconds improve_time{};
+
+    std::string output{};
+};
+
+// Reads a job file, which holds one setting per line. Blank lines and lines starting with '#' are ignored.
+//
+//     part <path>                     Adds an STL file. The settings below apply to the last part added.
+//     quantity <count>                Defaults to 1
+//     rotations none|cubic|arbitrary  Defaults to cubic
+//     min_hole <size>                 Defaults to 1
+//     minimize                        Rotate the part to its smallest bounding box first
+//     mirror                          Mirror the part along the x axis
+//
+//     resolution <mm>
+//     initial <x> <y> <z>
+//     maximum <x> <y> <z>
+//     sinterbox [<clearance> <spacing> <thickness> <width>]
+//     threads <count>
+//     attempts <count>
+//     improve <seconds>
+//     output <path>                   Defaults to the job file with an .stl extension
+//
+// Relative paths are relative to the job file. Throws `std::runtime_error` on any malformed line.
+job read_job(const std::string& file_path);
+
+} // namespace pstack::cli
+
+#endif // PSTACK_CLI_JOB_HPP
@@ -0,0 +1,198 @@
+#include "pstack/calc/stack_scheduler.hpp"
+#include "pstack/cli/job.hpp"
+#include "pstack/files/stl.hpp"
+#include "pstack/util/trace.hpp"
+#include "pstack/version.hpp"
+#include <atomic>
+#include <charconv>
+#include <csignal>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pstack::cli {
+
+namespace {
+
+volatile std::sig_atomic_t interrupted = 0;
+
+void on_interrupt(int) {
+    interrupted = 1;
+}
+
+std::string format_statistics(const calc::stack_statistics& statistics) {
+    const auto seconds = [](const std::chrono::nanoseconds time) {
+        return std::chrono::duration_cast<std::chrono::duration<double>>(time).count();
+    };
+    char buffer[512];
+    std::snprintf(buffer, sizeof(buffer),
+        "  Time: min box %.2fs, rotation %.2fs, voxelization %.2fs, placement %.2fs, enlargement %.2fs, improvement %.2fs\n"
+        "  Work: %llu can_place calls, %llu voxels tested, %llu early rejections, %llu enlargement rounds, %llu cached orientations, %.1f MiB peak grid memory\n",
+        seconds(statistics.min_box), seconds(statistics.rotation), seconds(statistics.voxelization),
+        seconds(statistics.placement), seconds(statistics.enlargement), seconds(statistics.improvement),
+        static_cast<unsigned long long>(statistics.can_place_calls), static_cast<unsigned long long>(statistics.voxels_tested),
+        static_cast<unsigned long long>(statistics.early_rejections), static_cast<unsigned long long>(statistics.enlargement_rounds),
+        static_cast<unsigned long long>(statistics.cached_orientations), statistics.peak_grid_memory / (1024.0 * 1024.0));
+    return buffer;
+}
+
+// Reads a job file into stacking parameters, which report the outcome of the job and count it if it succeeds
+calc::stack_parameters read_parameters(const std::string& job_path, const std::string& cache_path, const bool show_statistics, std::atomic<std::size_t>& succeeded) {
+    const auto spec = std::make_shared<const job>(read_job(job_path));
+    const auto done = std::make_shared<std::atomic<bool>>(false);
+
+    calc::stack_parameters params{
+        .parts = {}, // Filled in below
+        .set_progress = [](double, double) {},
+        .display_preview = {},
+        .on_success = [=, &succeeded](calc::stack_result result, const std::chrono::system_clock::duration elapsed) {
+            const auto bounding = result.mesh.bounding();
+            result.size = bounding.max - bounding.min;
+            result.density = result.mesh.volume_and_centroid().volume / (result.size.x * result.size.y * result.size.z);
+            if (spec->sinterbox.has_value()) {
+                calc::add_sinterbox(result, *spec->sinterbox);
+            }
+            if (not files::to_stl(result.mesh, spec->output)) {
+                std::fprintf(stderr, "%s: Could not write %s\n", job_path.c_str(), spec->output.c_str());
+                *done = true;
+                return;
+            }
+
+            // One call, so that the lines of jobs finishing at once don't interleave
+            std::printf("%s: %zu pieces in %.1fx%.1fx%.1fmm (%.1f%% density) after %.1fs, written to %s\n%s",
+                job_path.c_str(), result.pieces.size(), result.size.x, result.size.y, result.size.z, 100 * result.density,
+                std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count(), spec->output.c_str(),
+                show_statistics ? format_statistics(result.statistics).c_str() : "");
+            *done = true;
+            ++succeeded;
+        },
+        .on_failure = [=] {
+            std::fprintf(stderr, "%s: Could not stack parts within maximum bounding box\n", job_path.c_str());
+            *done = true;
+        },
+        .on_finish = [=] {
+            if (not *done) {
+                std::fprintf(stderr, "%s: Stopped before any stack was complete\n", job_path.c_str());
+            }
+        },
+
+        .resolution = spec->resolution,
+        .x_min = spec->x_min, .x_max = spec->x_max,
+        .y_min = spec->y_min, .y_max = spec->y_max,
+        .z_min = spec->z_min, .z_max = spec->z_max,
+
+        .threads = spec->threads,
+        .attempts = spec->attempts,
+        .improve_time = spec->improve_time,
+        .preview_interval = {},
+        .voxel_cache = cache_path,
+    };
+    for (const calc::part& part : spec->parts) {
+        params.parts.push_back(std::make_shared<const calc::part>(part));
+    }
+    return params;
+}
+
+void print_usage() {
+    std::printf(
+        "Usage: PartStackerCLI [options] <job file>...\n"
+        "\n"
+        "Stacks the parts described by each job file, and writes the result as an STL file.\n"
+        "Interrupting keeps the best stack found so far for the running jobs, and skips the rest.\n"
+        "\n"
+        "Options:\n"
+        "  -c, --cache <path>    Keep voxelized parts in this directory, so that stacking them again skips voxelizing them\n"
+        "  -j, --jobs <count>    Number of jobs stacked at once, where 0 means one per hardware thread (default 1)\n"
+        "  -m, --memory <MiB>    Don't start another job if the running ones would need more memory than this\n"
+        "  -s, --statistics      Show where the time of each job went, and how much work it did\n"
+        "  -t, --trace <path>    Record what every thread did, and write it as a trace for chrome://tracing or Perfetto\n"
+        "  -h, --help            Show this message\n"
+        "  -v, --version         Show the version\n");
+}
+
+} // namespace
+
+} // namespace pstack::cli
+
+int main(int argc, char** argv) {
+    using namespace pstack;
+
+    std::size_t max_jobs = 1;
+    std::size_t memory_limit = 0;
+    bool show_statistics = false;
+    std::string trace_path{};
+    std::string cache_path{};
+    std::vector<std::string> job_paths{};
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "-h" or arg == "--help") {
+            cli::print_usage();
+            return 0;
+        } else if (arg == "-v" or arg == "--version") {
+            std::printf("PartStacker Community Edition v%d.%d.%d\n", version::major, version::minor, version::patch);
+            return 0;
+        } else if (arg == "-s" or arg == "--statistics") {
+            show_statistics = true;
+        } else if (arg == "-t" or arg == "--trace" or arg == "-c" or arg == "--cache") {
+            if (i + 1 == argc) {
+                std::fprintf(stderr, "Expected a path after %s\n", arg.data());
+                return 2;
+            }
+            std::string& path = (arg == "-t" or arg == "--trace") ? trace_path : cache_path;
+            path = argv[++i];
+        } else if (arg == "-j" or arg == "--jobs" or arg == "-m" or arg == "--memory") {
+            const std::string_view text = (i + 1 < argc) ? argv[++i] : "";
+            std::size_t value = 0;
+            const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+            if (text.empty() or error != std::errc{} or end != text.data() + text.size()) {
+                std::fprintf(stderr, "Expected a number after %s\n", arg.data());
+                return 2;
+            }
+            if (arg == "-j" or arg == "--jobs") {
+                max_jobs = value;
+            } else {
+                memory_limit = value;
+            }
+        } else {
+            job_paths.emplace_back(arg);
+        }
+    }
+    if (job_paths.empty()) {
+        cli::print_usage();
+        return 2;
+    }
+
+    std::signal(SIGINT, cli::on_interrupt);
+
+    if (not trace_path.empty()) {
+        util::start_trace();
+    }
+
+    std::size_t failures = 0;
+    std::atomic<std::size_t> succeeded = 0;
+    calc::stack_scheduler scheduler(max_jobs, memory_limit * 1024 * 1024);
+    for (const std::string& path : job_paths) {
+        try {
+            scheduler.submit(cli::read_parameters(path, cache_path, show_statistics, succeeded));
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "%s\n", e.what());
+            ++failures;
+        }
+    }
+
+    // Signal handlers can't take locks, so poll for an interruption here instead
+    while (not scheduler.wait_for(std::chrono::milliseconds(100))) {
+        if (cli::interrupted) {
+            scheduler.cancel_all();
+        }
+    }
+
+    if (not trace_path.empty() and not util::stop_trace(trace_path)) {
+        std::fprintf(stderr, "Could not write %s\n", trace_path.c_str());
+        ++failures;
+    }
+    return (failures == 0 and succeeded == job_paths.size()) ? 0 : 1;
+}
@@ -1,6 +1,7 @@
 #include "pstack/files/read.hpp"
 #include "pstack/files/stl.hpp"
 #include "pstack/geo/triangle.hpp"
+#include "pstack/util/trace.hpp"
 #include <array>
 #include <fstream>
 #include <ranges>
@@ -10,6 +11,7 @@
 namespace pstack::files {
 
 calc::mesh from_stl(const std::string& file_path) {
+    const util::trace_scope trace("from_stl");
     std::string file = read_file(file_path);
     if (file.empty()) {
         return {};
@@ -81,7 +83,8 @@ calc::mesh from_stl(const std::string& file_path) {
     return calc::mesh(std::move(triangles));
 }
 
-void to_stl(const calc::mesh& mesh, const std::string& file_path) {
+bool to_stl(const calc::mesh& mesh, const std::string& file_path) {
+    const util::trace_scope trace("to_stl");
     std::ofstream file(file_path, std::ios::out | std::ios::binary);
 
     const std::array<std::byte, 80> header{};
@@ -106,6 +109,8 @@ void to_stl(const calc::mesh& mesh, const std::string& file_path) {
         reinterpret_cast<float*>(triangle.data())[11] = t.v3.z;
         file.write(reinterpret_cast<const char*>(triangle.data()), triangle.size());
     }
+    file.close();
+    return not file.fail();
 }
 
 } // namespace pstack::files
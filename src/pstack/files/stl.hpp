@@ -7,7 +7,8 @@
 namespace pstack::files {
 
 calc::mesh from_stl(const std::string& file_path);
-void to_stl(const calc::mesh& mesh, const std::string& file_path);
+// Returns whether the whole file could be written
+bool to_stl(const calc::mesh& mesh, const std::string& file_path);
 
 } // namespace pstack::files
 
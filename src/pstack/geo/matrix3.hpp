@@ -63,6 +63,13 @@ constexpr matrix3<T> operator*(const std::type_identity_t<T>& lhs, const matrix3
              lhs * rhs.zx, lhs * rhs.zy, lhs * rhs.zz };
 }
 
+template <class T>
+constexpr matrix3<T> transpose(const matrix3<T>& m) {
+    return { m.xx, m.yx, m.zx,
+             m.xy, m.yy, m.zy,
+             m.xz, m.yz, m.zz };
+}
+
 template <class T>
 constexpr matrix3<T> rot3(const vector3<T>& axis, const std::type_identity_t<T> theta) {
     const T c = static_cast<T>(cos(theta));
@@ -1,17 +1,26 @@
 #include <GL/glew.h> // must be included first
 #include "pstack/graphics/buffer.hpp"
 
+#include <algorithm>
 #include <cassert>
 
 namespace pstack::graphics {
 
-void vertex_buffer::initialize(GLuint location) {
+vertex_buffer::~vertex_buffer() {
+    // Nothing was created on the GPU unless initialized
+    if (-1 != _handle) {
+        glDeleteBuffers(1, &_handle);
+    }
+}
+
+void vertex_buffer::initialize(GLuint location, GLuint divisor) {
     static_assert(std::same_as<GLuint, decltype(_handle)>);
     assert(-1 == _handle);
     assert(-1 == _location);
     assert(_vertices.empty());
     glGenBuffers(1, &_handle);
     _location = location;
+    _divisor = divisor;
 }
 
 void vertex_buffer::set(std::vector<geo::vector3<float>>&& vertices) {
@@ -20,9 +29,33 @@ void vertex_buffer::set(std::vector<geo::vector3<float>>&& vertices) {
     glBufferData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(_vertices[0]), _vertices.data(), GL_STATIC_DRAW);
     glVertexAttribPointer(_location, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(_location);
+    glVertexAttribDivisor(_location, _divisor);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    _capacity = _vertices.size();
+}
+
+void vertex_buffer::append(const std::vector<geo::vector3<float>>& vertices) {
+    const std::size_t old_size = _vertices.size();
+    _vertices.insert(_vertices.end(), vertices.begin(), vertices.end());
+    glBindBuffer(GL_ARRAY_BUFFER, _handle);
+    if (_vertices.size() > _capacity) {
+        // Grow geometrically, so that a stack built up a few pieces at a time is only uploaded in full a handful of times
+        _capacity = std::max(_vertices.size(), 2 * _capacity);
+        glBufferData(GL_ARRAY_BUFFER, _capacity * sizeof(_vertices[0]), nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, _vertices.size() * sizeof(_vertices[0]), _vertices.data());
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, old_size * sizeof(_vertices[0]), vertices.size() * sizeof(_vertices[0]), vertices.data());
+    }
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+vertex_array_object::~vertex_array_object() {
+    _vertex_buffers.clear();
+    if (-1 != _handle) {
+        glDeleteVertexArrays(1, &_handle);
+    }
+}
+
 void vertex_array_object::initialize() {
     static_assert(std::same_as<GLuint, decltype(_handle)>);
     assert(-1 == _handle);
@@ -38,6 +71,18 @@ void vertex_array_object::add_vertex_buffer(GLuint location, std::vector<geo::ve
     glBindVertexArray(0);
 }
 
+void vertex_array_object::add_instance_buffer(GLuint location, std::vector<geo::vector3<float>>&& instances) {
+    glBindVertexArray(_handle);
+    auto& buffer = _vertex_buffers.emplace_back();
+    buffer.initialize(location, 1);
+    buffer.set(std::move(instances));
+    glBindVertexArray(0);
+}
+
+void vertex_array_object::append_vertices(const std::size_t i, const std::vector<geo::vector3<float>>& vertices) {
+    _vertex_buffers[i].append(vertices);
+}
+
 void vertex_array_object::bind_arrays() {
     glBindVertexArray(_handle);
 }
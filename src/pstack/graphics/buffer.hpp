@@ -2,6 +2,7 @@
 #define PSTACK_GRAPHICS_BUFFERS_HPP
 
 #include "pstack/geo/vector3.hpp"
+#include <utility>
 #include <vector>
 
 namespace pstack::graphics {
@@ -9,32 +10,68 @@ namespace pstack::graphics {
 class vertex_buffer {
 public:
     vertex_buffer() = default;
+    ~vertex_buffer();
     vertex_buffer(const vertex_buffer&) = delete;
     vertex_buffer& operator=(const vertex_buffer&) = delete;
-    vertex_buffer(vertex_buffer&&) = default;
-    vertex_buffer& operator=(vertex_buffer&&) = default;
 
-    void initialize(unsigned int location);
+    vertex_buffer(vertex_buffer&& other) noexcept
+        : _vertices(std::move(other._vertices))
+        , _capacity(std::exchange(other._capacity, 0))
+        , _handle(std::exchange(other._handle, -1))
+        , _location(std::exchange(other._location, -1))
+        , _divisor(other._divisor)
+    {}
+
+    vertex_buffer& operator=(vertex_buffer&& other) noexcept {
+        std::swap(_vertices, other._vertices);
+        std::swap(_capacity, other._capacity);
+        std::swap(_handle, other._handle);
+        std::swap(_location, other._location);
+        std::swap(_divisor, other._divisor);
+        return *this;
+    }
+
+    // A `divisor` of one advances the attribute once per instance instead of once per vertex
+    void initialize(unsigned int location, unsigned int divisor = 0);
     void set(std::vector<geo::vector3<float>>&& vertices);
 
+    // Uploads only the new vertices, unless the buffer on the GPU has to grow
+    void append(const std::vector<geo::vector3<float>>& vertices);
+
     std::size_t size() const {
         return _vertices.size();
     }
 
 private:
     std::vector<geo::vector3<float>> _vertices{};
+    std::size_t _capacity = 0; // Of the buffer on the GPU, in vertices
     unsigned int _handle = -1;
     unsigned int _location = -1;
+    unsigned int _divisor = 0;
 };
 
 class vertex_array_object {
 public:
     vertex_array_object() = default;
+    ~vertex_array_object();
     vertex_array_object(const vertex_array_object&) = delete;
     vertex_array_object& operator=(const vertex_array_object&) = delete;
 
+    vertex_array_object(vertex_array_object&& other) noexcept
+        : _vertex_buffers(std::move(other._vertex_buffers))
+        , _handle(std::exchange(other._handle, -1))
+    {}
+
+    vertex_array_object& operator=(vertex_array_object&& other) noexcept {
+        std::swap(_vertex_buffers, other._vertex_buffers);
+        std::swap(_handle, other._handle);
+        return *this;
+    }
+
     void initialize();
     void add_vertex_buffer(unsigned int location, std::vector<geo::vector3<float>>&& vertices);
+    void add_instance_buffer(unsigned int location, std::vector<geo::vector3<float>>&& instances);
+    void append_vertices(std::size_t i, const std::vector<geo::vector3<float>>& vertices);
 
     void bind_arrays();
 
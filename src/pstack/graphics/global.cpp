@@ -31,4 +31,8 @@ void draw_triangles(GLsizei count) {
     glDrawArrays(GL_TRIANGLES, 0, count);
 }
 
+void draw_triangles(GLsizei count, GLsizei instances) {
+    glDrawArraysInstanced(GL_TRIANGLES, 0, count, instances);
+}
+
 } // namespace pstack::graphics
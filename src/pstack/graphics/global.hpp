@@ -14,6 +14,9 @@ void clear(float r, float g, float b, float a);
 
 void draw_triangles(int count);
 
+// Draws `count` vertices once for each instance
+void draw_triangles(int count, int instances);
+
 } // namespace pstack::graphics
 
 #endif // PSTACK_GRAPHICS_GLOBAL_HPP
@@ -11,6 +11,7 @@
 #include <wx/menu.h>
 #include <wx/msgdlg.h>
 #include <wx/sizer.h>
+#include <wx/stdpaths.h>
 
 namespace pstack::gui {
 
@@ -101,7 +102,7 @@ void main_window::set_result(const std::size_t index) {
     const auto bounding = result.mesh.bounding();
     const auto size = bounding.max - bounding.min;
     const auto centroid = (size / 2) + geo::origin3<float>;
-    _viewport->set_mesh(result.mesh, centroid);
+    _viewport->set_result(result, centroid);
 }
 
 void main_window::unset_result() {
@@ -156,10 +157,14 @@ void main_window::on_stacking_start() {
                 _controls.progress_bar->SetValue(static_cast<int>(100 * progress / total));
             });
         },
-        .display_mesh = [this](const calc::mesh& mesh, int max_x, int max_y, int max_z) {
-            CallAfter([=] {
-                // Make a copy of `mesh`, otherwise we encounter a data race
-                _viewport->set_mesh(mesh, { max_x / 2.0f, max_y / 2.0f, max_z / 2.0f });
+        .display_preview = [this](calc::stack_preview preview) {
+            CallAfter([this, preview = std::move(preview)] {
+                const geo::point3<float> centroid = { preview.box.x / 2.0f, preview.box.y / 2.0f, preview.box.z / 2.0f };
+                if (preview.reset) {
+                    _viewport->set_preview(preview.added, centroid);
+                } else {
+                    _viewport->append_mesh(preview.added, centroid);
+                }
             });
         },
         .on_success = [this](calc::stack_result result, const std::chrono::system_clock::duration elapsed) {
@@ -183,7 +188,13 @@ void main_window::on_stacking_start() {
         .x_min = _controls.initial_x_spinner->GetValue(), .x_max = _controls.maximum_x_spinner->GetValue(),
         .y_min = _controls.initial_y_spinner->GetValue(), .y_max = _controls.maximum_y_spinner->GetValue(),
         .z_min = _controls.initial_z_spinner->GetValue(), .z_max = _controls.maximum_z_spinner->GetValue(),
+
+        .attempts = _preferences.several_orders ? std::size_t{8} : std::size_t{1},
+        .improve_time = _preferences.improve_results ? std::chrono::seconds(30) : std::chrono::seconds(0),
     };
+    if (_preferences.cache_voxels) {
+        params.voxel_cache = (wxStandardPaths::Get().GetUserLocalDataDir() + "/voxels").utf8_string();
+    }
     enable_on_stacking(true);
     _stacker_thread.start(std::move(params));
 }
@@ -198,10 +209,21 @@ void main_window::on_stacking_success(calc::stack_result result, const std::chro
     _results_list.append(std::move(result));
     set_result(_results_list.rows() - 1);
 
+    const auto seconds = [](const auto duration) {
+        return std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+    };
+    const calc::stack_statistics& statistics = _current_result->statistics;
     const auto message = wxString::Format(
-        "Stacking complete!\n\nElapsed time: %.1fs\n\nFinal bounding box: %.1fx%.1fx%.1fmm (%.1f%% density).",
-        std::chrono::duration_cast<std::chrono::duration<double>>(elapsed).count(),
-        _current_result->size.x, _current_result->size.y, _current_result->size.z, 100 * _current_result->density);
+        "Stacking complete!\n\nElapsed time: %.1fs\n\nFinal bounding box: %.1fx%.1fx%.1fmm (%.1f%% density).\n\n"
+        "Min box search: %.2fs\nRotation: %.2fs\nVoxelization: %.2fs\nPlacement: %.2fs\nEnlargement: %.2fs (%llu rounds)\nImprovement: %.2fs\n\n"
+        "Placement tests: %llu\nVoxels tested: %llu\nEarly rejections: %llu\nCached orientations: %llu\nPeak grid memory: %.1f MiB",
+        seconds(elapsed),
+        _current_result->size.x, _current_result->size.y, _current_result->size.z, 100 * _current_result->density,
+        seconds(statistics.min_box), seconds(statistics.rotation), seconds(statistics.voxelization), seconds(statistics.placement),
+        seconds(statistics.enlargement), static_cast<unsigned long long>(statistics.enlargement_rounds), seconds(statistics.improvement),
+        static_cast<unsigned long long>(statistics.can_place_calls), static_cast<unsigned long long>(statistics.voxels_tested),
+        static_cast<unsigned long long>(statistics.early_rejections), static_cast<unsigned long long>(statistics.cached_orientations),
+        statistics.peak_grid_memory / (1024.0 * 1024.0));
     wxMessageBox(message, "Stacking complete");
 }
 
@@ -260,7 +282,7 @@ wxMenuBar* main_window::make_menu_bar() {
          // Menu items cannot be 0 on Mac
         new_ = 1, open, save, close,
         import, export_,
-        pref_scroll, pref_extra,
+        pref_scroll, pref_extra, pref_orders, pref_improve, pref_cache,
         about, website,
     };
     menu_bar->Bind(wxEVT_MENU, [this](wxCommandEvent& event) {
@@ -297,6 +319,18 @@ wxMenuBar* main_window::make_menu_bar() {
                 _parts_list.reload_all_text();
                 break;
             }
+            case menu_item::pref_orders: {
+                _preferences.several_orders = not _preferences.several_orders;
+                break;
+            }
+            case menu_item::pref_improve: {
+                _preferences.improve_results = not _preferences.improve_results;
+                break;
+            }
+            case menu_item::pref_cache: {
+                _preferences.cache_voxels = not _preferences.cache_voxels;
+                break;
+            }
             case menu_item::about: {
                 constexpr auto str =
                     "PartStacker Community Edition\n\n"
@@ -329,6 +363,9 @@ wxMenuBar* main_window::make_menu_bar() {
     auto preferences_menu = new wxMenu();
     preferences_menu->AppendCheckItem((int)menu_item::pref_scroll, "Invert &scroll", "Change the viewport scroll direction");
     preferences_menu->AppendCheckItem((int)menu_item::pref_extra, "Display &extra parts", "Display the extra part quantity separately");
+    preferences_menu->AppendCheckItem((int)menu_item::pref_orders, "Try several part &orders", "Stack the parts in several orders at once and keep the smallest result");
+    preferences_menu->AppendCheckItem((int)menu_item::pref_improve, "Keep &improving results", "Spend 30 more seconds shrinking each result, or until stopped");
+    preferences_menu->AppendCheckItem((int)menu_item::pref_cache, "&Cache voxelized parts", "Keep voxelized parts on disk, so that stacking them again starts sooner");
     menu_bar->Append(preferences_menu, "&Preferences");
 
     auto help_menu = new wxMenu();
@@ -496,7 +533,9 @@ void main_window::on_export_result(wxCommandEvent& event) {
     }
 
     const wxString path = dialog.GetPath();
-    files::to_stl(_current_result->mesh, path.ToStdString());
+    if (not files::to_stl(_current_result->mesh, path.ToStdString())) {
+        wxMessageBox("Could not write " + path, "Export failed", wxICON_ERROR);
+    }
     event.Skip();
 }
 
@@ -523,18 +562,12 @@ void main_window::on_sinterbox_result(wxCommandEvent& event) {
     }
 
     auto result = *_current_result; // Copy the result
-    const double offset = _controls.thickness_spinner->GetValue() + _controls.clearance_spinner->GetValue();
-    const auto bounding = result.mesh.bounding();
-    result.mesh.set_baseline(geo::origin3<float> + offset);
-    result.sinterbox = calc::sinterbox_parameters{
-        .min = bounding.min + offset,
-        .max = bounding.max + offset,
+    calc::add_sinterbox(result, {
         .clearance = _controls.clearance_spinner->GetValue(),
+        .spacing = _controls.spacing_spinner->GetValue(),
         .thickness = _controls.thickness_spinner->GetValue(),
         .width = _controls.width_spinner->GetValue(),
-        .spacing = _controls.spacing_spinner->GetValue() + 0.00013759,
-    };
-    result.mesh.add_sinterbox(*result.sinterbox);
+    });
 
     _results_list.append(std::move(result));
     set_result(_results_list.rows() - 1);
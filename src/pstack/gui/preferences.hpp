@@ -6,6 +6,9 @@ namespace pstack::gui {
 struct preferences {
     bool invert_scroll = false;
     bool extra_parts = false;
+    bool several_orders = false;
+    bool improve_results = false;
+    bool cache_voxels = false;
 };
 
 } // namespace pstack::gui
@@ -5,6 +5,8 @@
 #include <wx/dcclient.h>
 #include <wx/msgdlg.h>
 #include <wx/string.h>
+#include <cassert>
+#include <map>
 
 namespace pstack::gui {
 
@@ -32,12 +34,17 @@ constexpr auto vertex_shader_source = R"(
     #version 330 core
     layout (location = 0) in vec3 aPos;
     layout (location = 1) in vec3 aNormal;
+    layout (location = 2) in vec3 aRotationX;
+    layout (location = 3) in vec3 aRotationY;
+    layout (location = 4) in vec3 aRotationZ;
+    layout (location = 5) in vec3 aTranslation;
     out vec4 frag_normal;
     uniform mat4 transform_vertices;
     uniform mat4 transform_normals;
     void main() {
-        gl_Position = transform_vertices * vec4(aPos, 1.0);
-        frag_normal = transform_normals * vec4(aNormal, 1.0);
+        mat3 rotation = mat3(aRotationX, aRotationY, aRotationZ);
+        gl_Position = transform_vertices * vec4(rotation * aPos + aTranslation, 1.0);
+        frag_normal = transform_normals * vec4(rotation * aNormal, 1.0);
     }
 )";
 
@@ -77,19 +84,16 @@ bool viewport::initialize() {
         return false;
     }
 
-    _vao.initialize();
     remove_mesh();
 
     return true;
 }
 
-void viewport::set_mesh(const calc::mesh& mesh, const geo::point3<float>& centroid) {
-    _vao.clear();
-
-    using vector3 = geo::vector3<float>;
+namespace {
 
-    std::vector<vector3> vertices;
-    std::vector<vector3> normals;
+void unpack_triangles(const calc::mesh& mesh, std::vector<geo::vector3<float>>& vertices, std::vector<geo::vector3<float>>& normals) {
+    vertices.reserve(3 * mesh.triangles().size());
+    normals.reserve(3 * mesh.triangles().size());
     for (const auto& t : mesh.triangles()) {
         vertices.push_back(t.v1.as_vector());
         vertices.push_back(t.v2.as_vector());
@@ -98,26 +102,118 @@ void viewport::set_mesh(const calc::mesh& mesh, const geo::point3<float>& centro
         normals.push_back(t.normal);
         normals.push_back(t.normal);
     }
+}
+
+// The rotation and translation of each copy of a mesh, with the rotation split into the columns the vertex shader puts back together
+struct instances {
+    std::vector<geo::vector3<float>> x{};
+    std::vector<geo::vector3<float>> y{};
+    std::vector<geo::vector3<float>> z{};
+    std::vector<geo::vector3<float>> translation{};
+
+    void add(const geo::matrix3<float>& rotation, const geo::vector3<float>& offset) {
+        x.push_back({ rotation.xx, rotation.yx, rotation.zx });
+        y.push_back({ rotation.xy, rotation.yy, rotation.zy });
+        z.push_back({ rotation.xz, rotation.yz, rotation.zz });
+        translation.push_back(offset);
+    }
+};
+
+instances single_instance() {
+    instances out{};
+    out.add(geo::eye3<float>, { 0, 0, 0 });
+    return out;
+}
+
+graphics::vertex_array_object upload(const calc::mesh& mesh, instances&& placed) {
+    std::vector<geo::vector3<float>> vertices;
+    std::vector<geo::vector3<float>> normals;
+    unpack_triangles(mesh, vertices, normals);
+
+    graphics::vertex_array_object vao{};
+    vao.initialize();
+    vao.add_vertex_buffer(0, std::move(vertices));
+    vao.add_vertex_buffer(1, std::move(normals));
+    vao.add_instance_buffer(2, std::move(placed.x));
+    vao.add_instance_buffer(3, std::move(placed.y));
+    vao.add_instance_buffer(4, std::move(placed.z));
+    vao.add_instance_buffer(5, std::move(placed.translation));
+    return vao;
+}
+
+} // namespace
+
+void viewport::set_mesh(const calc::mesh& mesh, const geo::point3<float>& centroid) {
+    _showing_preview = false;
+    _vaos.clear();
+    _vaos.push_back(upload(mesh, single_instance()));
+
+    _bounding = mesh.bounding();
+    fit_transform(centroid);
+    render();
+}
+
+void viewport::set_preview(const calc::mesh& mesh, const geo::point3<float>& centroid) {
+    set_mesh(mesh, centroid);
+    _showing_preview = true;
+}
+
+void viewport::set_result(const calc::stack_result& result, const geo::point3<float>& centroid) {
+    _showing_preview = false;
+    _vaos.clear();
+
+    // Each part is uploaded once, and drawn once for each of its pieces
+    std::map<const calc::mesh*, instances> parts{};
+    for (const auto& piece : result.pieces) {
+        parts[piece.part_mesh.get()].add(piece.rotation, piece.translation);
+    }
+    for (auto& [mesh, placed] : parts) {
+        _vaos.push_back(upload(*mesh, std::move(placed)));
+    }
+    if (result.sinterbox.has_value()) {
+        std::vector<geo::triangle> triangles{};
+        calc::append_sinterbox(triangles, *result.sinterbox);
+        _vaos.push_back(upload(calc::mesh(std::move(triangles)), single_instance()));
+    }
+
+    _bounding = result.mesh.bounding();
+    fit_transform(centroid);
+    render();
+}
+
+void viewport::append_mesh(const calc::mesh& mesh, const geo::point3<float>& centroid) {
+    // A part or a result was shown while stacking, so the preview carries on from the next reset
+    if (not _showing_preview) {
+        return;
+    }
+    assert(_vaos.size() == 1 and _vaos.front()[2].size() == 1); // A single instance, as `set_preview` uploads it
+
+    std::vector<geo::vector3<float>> vertices;
+    std::vector<geo::vector3<float>> normals;
+    unpack_triangles(mesh, vertices, normals);
 
-    _vao.add_vertex_buffer(0, std::move(vertices));
-    _vao.add_vertex_buffer(1, std::move(normals));
+    _vaos.front().append_vertices(0, vertices);
+    _vaos.front().append_vertices(1, normals);
 
     const auto bounding = mesh.bounding();
+    _bounding.min = { std::min(_bounding.min.x, bounding.min.x), std::min(_bounding.min.y, bounding.min.y), std::min(_bounding.min.z, bounding.min.z) };
+    _bounding.max = { std::max(_bounding.max.x, bounding.max.x), std::max(_bounding.max.y, bounding.max.y), std::max(_bounding.max.z, bounding.max.z) };
+    fit_transform(centroid);
+    render();
+}
+
+void viewport::fit_transform(const geo::point3<float>& centroid) {
     _transform.translation(geo::origin3<float> - centroid);
-    const auto size = bounding.max - bounding.min;
+    const auto size = _bounding.max - _bounding.min;
     const auto zoom_factor = 1 / std::max({ size.x, size.y, size.z });
     _transform.scale_mesh(zoom_factor);
     _shader.set_uniform("transform_vertices", _transform.for_vertices());
     _shader.set_uniform("transform_normals", _transform.for_normals());
-
-    render();
 }
 
 void viewport::remove_mesh() {
-    _vao.clear();
-
-    _vao.add_vertex_buffer(0, {});
-    _vao.add_vertex_buffer(1, {});
+    _showing_preview = false;
+    _vaos.clear();
 
     _transform.translation({ 0, 0, 0 });
     _transform.scale_mesh(1);
@@ -141,8 +237,10 @@ void viewport::render(wxDC& dc) {
 
     graphics::clear(40 / 255.0, 50 / 255.0, 120 / 255.0, 1);
     _shader.use_program();
-    _vao.bind_arrays();
-    graphics::draw_triangles(_vao[0].size());
+    for (auto& vao : _vaos) {
+        vao.bind_arrays();
+        graphics::draw_triangles(vao[0].size(), vao[2].size());
+    }
 
     SwapBuffers();
 }
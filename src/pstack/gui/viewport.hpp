@@ -6,11 +6,13 @@
 #include "pstack/graphics/shader.hpp"
 
 #include "pstack/calc/mesh.hpp"
+#include "pstack/calc/stacker.hpp"
 #include "pstack/gui/transformation.hpp"
 
 #include <wx/event.h>
 #include <wx/glcanvas.h>
 #include <memory>
+#include <vector>
 
 namespace pstack::gui {
 
@@ -26,6 +28,12 @@ private:
 
 public:
     void set_mesh(const calc::mesh& mesh, const geo::point3<float>& centroid);
+    // Shows the start of a stacking preview, which `append_mesh` then adds to
+    void set_preview(const calc::mesh& mesh, const geo::point3<float>& centroid);
+    // Adds to the preview shown, uploading only the new triangles. Does nothing if something else has been shown since.
+    void append_mesh(const calc::mesh& mesh, const geo::point3<float>& centroid);
+    // Draws each piece as a copy of its part, so every part is only uploaded once
+    void set_result(const calc::stack_result& result, const geo::point3<float>& centroid);
     void remove_mesh();
     void render();
 
@@ -35,6 +43,7 @@ public:
 
 private:
     void render(wxDC& dc);
+    void fit_transform(const geo::point3<float>& centroid);
     void on_paint(wxPaintEvent&);
     void on_size(wxSizeEvent& event);
 
@@ -52,8 +61,10 @@ private:
     bool _opengl_initialized = false;
 
     graphics::shader _shader{};
-    graphics::vertex_array_object _vao{};
+    std::vector<graphics::vertex_array_object> _vaos{}; // One for each distinct mesh shown
+    bool _showing_preview = false;                      // If so, it's the only mesh, drawn once
     transformation _transform{};
+    calc::mesh::bounding_t _bounding{}; // Of the mesh shown
 
     wxSize _viewport_size{};
 };
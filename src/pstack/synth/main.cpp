@@ -0,0 +1,119 @@
+#include "pstack/synth/workload.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pstack::synth {
+
+namespace {
+
+// Reads all of `text` as one value
+template <class T>
+bool parse(const std::string_view text, T& out) {
+    std::istringstream stream{ std::string(text) };
+    stream >> out;
+    return not stream.fail() and stream.eof();
+}
+
+// Reads a comma separated list of `shape:quantity`
+bool parse_mix(std::string_view text, std::vector<workload_options::entry>& out) {
+    out.clear();
+    while (not text.empty()) {
+        const std::string_view item = text.substr(0, text.find(','));
+        text.remove_prefix(std::min(text.size(), item.size() + 1));
+
+        const std::size_t colon = item.find(':');
+        const auto kind = shape_from_name(item.substr(0, colon));
+        int quantity = 1;
+        if (not kind.has_value() or (colon != std::string_view::npos and (not parse(item.substr(colon + 1), quantity) or quantity < 0))) {
+            return false;
+        }
+        out.push_back({ *kind, quantity });
+    }
+    return not out.empty();
+}
+
+void print_usage() {
+    std::printf(
+        "Usage: PartStackerSynth [options] <directory>\n"
+        "\n"
+        "Writes generated parts as binary STL files into the directory, along with workload.job,\n"
+        "which PartStackerCLI can stack.\n"
+        "\n"
+        "Options:\n"
+        "  -m, --mix <list>          Parts as shape:quantity, separated by commas, where a shape is one of\n"
+        "                            cube, torus, gear, lattice, or shell (default cube:4,torus:4,gear:4,lattice:2,shell:2)\n"
+        "  -t, --triangles <count>   Roughly how many triangles each part has (default 2000)\n"
+        "  -s, --size <mm>           Roughly how large each part is (default 30)\n"
+        "      --seed <number>       Varies the size of each part (default 1)\n"
+        "      --min-hole <size>     Minimum hole size of each part (default 1)\n"
+        "      --rotations <set>     One of none, cubic, or arbitrary (default cubic)\n"
+        "  -r, --resolution <mm>     Resolution of the job (default 1)\n"
+        "  -h, --help                Show this message\n");
+}
+
+} // namespace
+
+} // namespace pstack::synth
+
+int main(int argc, char** argv) {
+    using namespace pstack;
+
+    synth::workload_options options{};
+    synth::parse_mix("cube:4,torus:4,gear:4,lattice:2,shell:2", options.mix);
+    std::string directory{};
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "-h" or arg == "--help") {
+            synth::print_usage();
+            return 0;
+        } else if (not arg.starts_with('-')) {
+            directory = arg;
+            continue;
+        }
+
+        const std::string_view value = (i + 1 < argc) ? argv[++i] : "";
+        bool valid = true;
+        if (arg == "-m" or arg == "--mix") {
+            valid = synth::parse_mix(value, options.mix);
+        } else if (arg == "-t" or arg == "--triangles") {
+            // Streams read a negative count as a huge unsigned one, rather than failing
+            valid = not value.starts_with('-') and synth::parse(value, options.triangles);
+        } else if (arg == "-s" or arg == "--size") {
+            valid = synth::parse(value, options.size) and options.size > 0;
+        } else if (arg == "--seed") {
+            valid = synth::parse(value, options.seed);
+        } else if (arg == "--min-hole") {
+            valid = synth::parse(value, options.min_hole) and options.min_hole >= 0;
+        } else if (arg == "--rotations") {
+            options.rotation_index = (value == "none") ? 0 : (value == "cubic") ? 1 : (value == "arbitrary") ? 2 : -1;
+            valid = options.rotation_index != -1;
+        } else if (arg == "-r" or arg == "--resolution") {
+            valid = synth::parse(value, options.resolution) and options.resolution > 0;
+        } else {
+            synth::print_usage();
+            return 2;
+        }
+        if (not valid) {
+            std::fprintf(stderr, "Invalid value \"%.*s\" for %s\n", static_cast<int>(value.size()), value.data(), arg.data());
+            return 2;
+        }
+    }
+    if (directory.empty()) {
+        synth::print_usage();
+        return 2;
+    }
+
+    try {
+        const auto job_path = synth::write_workload(options, directory);
+        std::printf("Wrote %s\n", job_path.string().c_str());
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
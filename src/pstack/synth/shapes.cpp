@@ -0,0 +1,206 @@
+#include "pstack/synth/shapes.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace pstack::synth {
+
+namespace {
+
+using point = geo::point3<float>;
+
+void add_triangle(std::vector<geo::triangle>& triangles, const point v1, const point v2, const point v3) {
+    triangles.push_back({ geo::normalize(geo::cross(v2 - v1, v3 - v1)), v1, v2, v3 });
+}
+
+// Adds a planar quad, with corners counterclockwise when seen from outside, split into a grid of smaller quads
+void add_quad(std::vector<geo::triangle>& triangles, const std::array<point, 4>& corners, const int divisions) {
+    const auto at = [&](const int i, const int j) {
+        const float u = static_cast<float>(i) / divisions;
+        const float v = static_cast<float>(j) / divisions;
+        const auto bottom = (1 - u) * corners[0].as_vector() + u * corners[1].as_vector();
+        const auto top = (1 - u) * corners[3].as_vector() + u * corners[2].as_vector();
+        return geo::origin3<float> + ((1 - v) * bottom + v * top);
+    };
+    for (int i = 0; i != divisions; ++i) {
+        for (int j = 0; j != divisions; ++j) {
+            add_triangle(triangles, at(i, j), at(i + 1, j), at(i + 1, j + 1));
+            add_triangle(triangles, at(i, j), at(i + 1, j + 1), at(i, j + 1));
+        }
+    }
+}
+
+void add_reversed_quad(std::vector<geo::triangle>& triangles, const std::array<point, 4>& corners, const int divisions) {
+    add_quad(triangles, { corners[3], corners[2], corners[1], corners[0] }, divisions);
+}
+
+enum face { neg_x, pos_x, neg_y, pos_y, neg_z, pos_z };
+
+// The corners of one face of a box, counterclockwise when seen from outside the box
+std::array<point, 4> box_face(const point min, const point max, const face f) {
+    const auto c = [&](const int x, const int y, const int z) {
+        return point{ x ? max.x : min.x, y ? max.y : min.y, z ? max.z : min.z };
+    };
+    switch (f) {
+        case neg_x: return { c(0, 0, 0), c(0, 0, 1), c(0, 1, 1), c(0, 1, 0) };
+        case pos_x: return { c(1, 0, 0), c(1, 1, 0), c(1, 1, 1), c(1, 0, 1) };
+        case neg_y: return { c(0, 0, 0), c(1, 0, 0), c(1, 0, 1), c(0, 0, 1) };
+        case pos_y: return { c(0, 1, 0), c(0, 1, 1), c(1, 1, 1), c(1, 1, 0) };
+        case neg_z: return { c(0, 0, 0), c(0, 1, 0), c(1, 1, 0), c(1, 0, 0) };
+        case pos_z: return { c(0, 0, 1), c(1, 0, 1), c(1, 1, 1), c(0, 1, 1) };
+    }
+    return {};
+}
+
+void add_box(std::vector<geo::triangle>& triangles, const point min, const point max, const int divisions) {
+    for (const face f : { neg_x, pos_x, neg_y, pos_y, neg_z, pos_z }) {
+        add_quad(triangles, box_face(min, max, f), divisions);
+    }
+}
+
+// The corners of a square at height `z`, counterclockwise when seen from above
+std::array<point, 4> square(const float min, const float max, const float z) {
+    return { point{ min, min, z }, point{ max, min, z }, point{ max, max, z }, point{ min, max, z } };
+}
+
+// The flat ring between two squares, facing up or down
+void add_frame(std::vector<geo::triangle>& triangles, const std::array<point, 4>& outer, const std::array<point, 4>& inner, const bool up, const int divisions) {
+    for (int k = 0; k != 4; ++k) {
+        const std::array<point, 4> corners = { outer[k], outer[(k + 1) % 4], inner[(k + 1) % 4], inner[k] };
+        if (up) {
+            add_quad(triangles, corners, divisions);
+        } else {
+            add_reversed_quad(triangles, corners, divisions);
+        }
+    }
+}
+
+} // namespace
+
+calc::mesh cube(const float size, const int divisions) {
+    std::vector<geo::triangle> triangles{};
+    triangles.reserve(12 * divisions * divisions);
+    add_box(triangles, { 0, 0, 0 }, { size, size, size }, divisions);
+    return calc::mesh(std::move(triangles));
+}
+
+calc::mesh torus(const float major, const float minor, const int segments) {
+    const auto vertex = [&](const int i, const int j) {
+        const double u = 2 * std::numbers::pi * i / segments;
+        const double v = 2 * std::numbers::pi * j / segments;
+        const double r = major + minor * std::cos(v);
+        return point{
+            static_cast<float>(r * std::cos(u)),
+            static_cast<float>(r * std::sin(u)),
+            static_cast<float>(minor * std::sin(v)),
+        };
+    };
+    std::vector<geo::triangle> triangles{};
+    triangles.reserve(2 * segments * segments);
+    for (int i = 0; i != segments; ++i) {
+        for (int j = 0; j != segments; ++j) {
+            add_triangle(triangles, vertex(i, j), vertex(i + 1, j), vertex(i + 1, j + 1));
+            add_triangle(triangles, vertex(i, j), vertex(i + 1, j + 1), vertex(i, j + 1));
+        }
+    }
+    calc::mesh out(std::move(triangles));
+    out.set_baseline({ 0, 0, 0 });
+    return out;
+}
+
+calc::mesh gear(const float radius, const float thickness, const int teeth, const int segments_per_tooth) {
+    const float root = 0.85f * radius;
+    const float bore = 0.3f * radius;
+    const int samples = teeth * segments_per_tooth;
+
+    // Each tooth is a flat tip and a flat root, joined by straight flanks
+    const auto outer_radius = [&](const double phase) {
+        if (phase < 0.35) {
+            return radius;
+        } else if (phase < 0.5) {
+            return static_cast<float>(radius + (root - radius) * (phase - 0.35) / 0.15);
+        } else if (phase < 0.85) {
+            return root;
+        }
+        return static_cast<float>(root + (radius - root) * (phase - 0.85) / 0.15);
+    };
+    const auto at = [](const double angle, const float r, const float z) {
+        return point{ static_cast<float>(r * std::cos(angle)), static_cast<float>(r * std::sin(angle)), z };
+    };
+
+    std::vector<geo::triangle> triangles{};
+    triangles.reserve(8 * samples);
+    for (int i = 0; i != samples; ++i) {
+        const double a0 = 2 * std::numbers::pi * i / samples;
+        const double a1 = 2 * std::numbers::pi * (i + 1) / samples;
+        const float r0 = outer_radius(static_cast<double>(i % segments_per_tooth) / segments_per_tooth);
+        const float r1 = outer_radius(static_cast<double>((i + 1) % segments_per_tooth) / segments_per_tooth);
+
+        add_quad(triangles, { at(a0, bore, thickness), at(a0, r0, thickness), at(a1, r1, thickness), at(a1, bore, thickness) }, 1);
+        add_reversed_quad(triangles, { at(a0, bore, 0), at(a0, r0, 0), at(a1, r1, 0), at(a1, bore, 0) }, 1);
+        add_quad(triangles, { at(a0, r0, 0), at(a1, r1, 0), at(a1, r1, thickness), at(a0, r0, thickness) }, 1);
+        add_reversed_quad(triangles, { at(a0, bore, 0), at(a1, bore, 0), at(a1, bore, thickness), at(a0, bore, thickness) }, 1);
+    }
+    calc::mesh out(std::move(triangles));
+    out.set_baseline({ 0, 0, 0 });
+    return out;
+}
+
+calc::mesh lattice(const float size, const int cells, const float strut) {
+    const float pitch = (size - strut) / cells;
+    std::vector<geo::triangle> triangles{};
+    triangles.reserve(36 * cells * (cells + 1) * (cells + 1));
+    for (int i = 0; i <= cells; ++i) {
+        for (int j = 0; j <= cells; ++j) {
+            for (int k = 0; k != cells; ++k) {
+                const float a = i * pitch;
+                const float b = j * pitch;
+                const float c = k * pitch;
+                add_box(triangles, { c, a, b }, { c + pitch + strut, a + strut, b + strut }, 1);
+                add_box(triangles, { a, c, b }, { a + strut, c + pitch + strut, b + strut }, 1);
+                add_box(triangles, { a, b, c }, { a + strut, b + strut, c + pitch + strut }, 1);
+            }
+        }
+    }
+    return calc::mesh(std::move(triangles));
+}
+
+calc::mesh hollow_box(const float size, const float wall, float opening, const int divisions) {
+    const float inner = size - 2 * wall;
+    opening = std::clamp(opening, 0.0f, inner);
+    const float window_min = (size - opening) / 2;
+    const float window_max = (size + opening) / 2;
+
+    std::vector<geo::triangle> triangles{};
+    triangles.reserve(44 * divisions * divisions);
+    const point outer_min = { 0, 0, 0 };
+    const point outer_max = { size, size, size };
+    const point cavity_min = { wall, wall, wall };
+    const point cavity_max = { size - wall, size - wall, size - wall };
+    for (const face f : { neg_x, pos_x, neg_y, pos_y, neg_z }) {
+        add_quad(triangles, box_face(outer_min, outer_max, f), divisions);
+        add_reversed_quad(triangles, box_face(cavity_min, cavity_max, f), divisions);
+    }
+
+    if (opening == 0) {
+        add_quad(triangles, box_face(outer_min, outer_max, pos_z), divisions);
+        add_reversed_quad(triangles, box_face(cavity_min, cavity_max, pos_z), divisions);
+        return calc::mesh(std::move(triangles));
+    }
+
+    // The top and the ceiling of the cavity are rings around the opening, joined by the walls of the opening
+    const auto window_top = square(window_min, window_max, size);
+    const auto window_bottom = square(window_min, window_max, size - wall);
+    add_frame(triangles, square(0, size, size), window_top, true, divisions);
+    if (opening < inner) {
+        add_frame(triangles, square(wall, size - wall, size - wall), window_bottom, false, divisions);
+    }
+    for (int k = 0; k != 4; ++k) {
+        add_quad(triangles, { window_bottom[k], window_top[k], window_top[(k + 1) % 4], window_bottom[(k + 1) % 4] }, divisions);
+    }
+    return calc::mesh(std::move(triangles));
+}
+
+} // namespace pstack::synth
@@ -0,0 +1,31 @@
+#ifndef PSTACK_SYNTH_SHAPES_HPP
+#define PSTACK_SYNTH_SHAPES_HPP
+
+#include "pstack/calc/mesh.hpp"
+
+namespace pstack::synth {
+
+// Closed meshes with outward normals, resting on the origin. Flat faces are split into a grid of `divisions` squared
+// quads, so that the triangle count can be raised without changing the shape.
+
+// `12 * divisions^2` triangles
+calc::mesh cube(float size, int divisions = 1);
+
+// Lying flat, with `2 * segments^2` triangles. The hole through the middle is carved away when `min_hole` is small enough.
+calc::mesh torus(float major, float minor, int segments);
+
+// A spur gear with a bore through its axis, and `8 * teeth * segments_per_tooth` triangles
+calc::mesh gear(float radius, float thickness, int teeth, int segments_per_tooth);
+
+// A cubic lattice of square struts, `cells` to a side, with `36 * cells * (cells + 1)^2` triangles.
+// Struts overlap where they meet, so the volume is overestimated, but the voxels are right.
+calc::mesh lattice(float size, int cells, float strut);
+
+// A cube with a cubic cavity, reached through a square opening in the top. An `opening` of zero seals the cavity,
+// which is then filled in when voxelizing, and any opening wider than `min_hole` lets the cavity be carved away.
+// At most `44 * divisions^2` triangles.
+calc::mesh hollow_box(float size, float wall, float opening, int divisions = 1);
+
+} // namespace pstack::synth
+
+#endif // PSTACK_SYNTH_SHAPES_HPP
@@ -0,0 +1,119 @@
+#include "pstack/files/stl.hpp"
+#include "pstack/synth/shapes.hpp"
+#include "pstack/synth/workload.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace pstack::synth {
+
+namespace {
+
+constexpr std::array shape_names = { "cube", "torus", "gear", "lattice", "shell" };
+constexpr std::array rotation_names = { "none", "cubic", "arbitrary" };
+
+int root(const double value) {
+    return std::max(1, static_cast<int>(std::lround(std::sqrt(value))));
+}
+
+} // namespace
+
+std::optional<shape> shape_from_name(const std::string_view name) {
+    for (std::size_t i = 0; i != shape_names.size(); ++i) {
+        if (name == shape_names[i]) {
+            return static_cast<shape>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+const char* shape_name(const shape kind) {
+    return shape_names[static_cast<std::size_t>(kind)];
+}
+
+calc::mesh make_shape(const shape kind, const float size, const std::size_t triangles) {
+    switch (kind) {
+        case shape::cube:
+            return cube(size, root(triangles / 12.0));
+        case shape::torus:
+            return torus(0.35f * size, 0.15f * size, std::max(8, root(triangles / 2.0)));
+        case shape::gear: {
+            static constexpr int teeth = 12;
+            return gear(size / 2, size / 4, teeth, std::max(3, static_cast<int>(triangles / (8 * teeth))));
+        }
+        case shape::lattice: {
+            int cells = 1;
+            while (36 * (cells + 1) * (cells + 2) * (cells + 2) <= static_cast<int>(triangles)) {
+                ++cells;
+            }
+            return lattice(size, cells, 0.2f * size / cells);
+        }
+        case shape::shell:
+            return hollow_box(size, 0.1f * size, 0.4f * size, root(triangles / 44.0));
+    }
+    return {};
+}
+
+std::shared_ptr<calc::part> make_part(std::string name, calc::mesh mesh, const int quantity) {
+    auto out = std::make_shared<calc::part>();
+    out->name = std::move(name);
+    out->mesh = std::move(mesh);
+    out->mesh.set_baseline({ 0, 0, 0 });
+
+    out->base_quantity = std::nullopt;
+    out->quantity = quantity;
+
+    const auto volume_and_centroid = out->mesh.volume_and_centroid();
+    out->volume = volume_and_centroid.volume;
+    out->centroid = volume_and_centroid.centroid;
+    out->triangle_count = out->mesh.triangles().size();
+    out->mirrored = false;
+    out->min_hole = 1;
+    out->rotation_index = 1;
+    out->rotate_min_box = false;
+    return out;
+}
+
+std::vector<std::shared_ptr<calc::part>> make_parts(const workload_options& options) {
+    std::mt19937 generator(options.seed);
+    std::uniform_real_distribution<float> variation(0.75f, 1.25f);
+
+    std::vector<std::shared_ptr<calc::part>> out{};
+    for (std::size_t i = 0; i != options.mix.size(); ++i) {
+        const auto [kind, quantity] = options.mix[i];
+        const float size = options.size * variation(generator);
+        auto part = make_part(shape_name(kind) + ("_" + std::to_string(i)), make_shape(kind, size, options.triangles), quantity);
+        part->min_hole = options.min_hole;
+        part->rotation_index = options.rotation_index;
+        out.push_back(std::move(part));
+    }
+    return out;
+}
+
+std::filesystem::path write_workload(const workload_options& options, const std::filesystem::path& directory) {
+    std::filesystem::create_directories(directory);
+    const std::filesystem::path job_path = directory / "workload.job";
+    std::ofstream job(job_path);
+    if (not job.is_open()) {
+        throw std::runtime_error("Could not write " + job_path.string());
+    }
+
+    job << "# Generated with size " << options.size << ", " << options.triangles << " triangles per part, and seed " << options.seed << "\n";
+    for (const auto& part : make_parts(options)) {
+        const std::string file_name = part->name + ".stl";
+        if (not files::to_stl(part->mesh, (directory / file_name).string())) {
+            throw std::runtime_error("Could not write " + (directory / file_name).string());
+        }
+        job << "\npart " << file_name << "\n"
+            << "quantity " << part->quantity << "\n"
+            << "rotations " << rotation_names[part->rotation_index] << "\n"
+            << "min_hole " << part->min_hole << "\n";
+    }
+    job << "\nresolution " << options.resolution << "\n";
+    return job_path;
+}
+
+} // namespace pstack::synth
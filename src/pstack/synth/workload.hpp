@@ -0,0 +1,51 @@
+#ifndef PSTACK_SYNTH_WORKLOAD_HPP
+#define PSTACK_SYNTH_WORKLOAD_HPP
+
+#include "pstack/calc/part.hpp"
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pstack::synth {
+
+enum class shape { cube, torus, gear, lattice, shell };
+
+std::optional<shape> shape_from_name(std::string_view name);
+const char* shape_name(shape kind);
+
+// A shape about `size` across its largest dimension, with roughly `triangles` triangles
+calc::mesh make_shape(shape kind, float size, std::size_t triangles);
+
+// A part with the same defaults as one loaded in the GUI
+std::shared_ptr<calc::part> make_part(std::string name, calc::mesh mesh, int quantity);
+
+struct workload_options {
+    struct entry {
+        shape kind;
+        int quantity;
+    };
+
+    std::vector<entry> mix{}; // One part for each entry, so a shape may appear several times in different sizes
+    float size = 30;          // Of each part, varied by up to a quarter either way
+    std::size_t triangles = 2000;
+    unsigned seed = 1;
+
+    int min_hole = 1;
+    int rotation_index = 1;
+    double resolution = 1;
+};
+
+// The parts of the workload, which are the same for the same options
+std::vector<std::shared_ptr<calc::part>> make_parts(const workload_options& options);
+
+// Writes each part as a binary STL into `directory`, along with a job file for PartStackerCLI that stacks them.
+// Returns the path of the job file.
+std::filesystem::path write_workload(const workload_options& options, const std::filesystem::path& directory);
+
+} // namespace pstack::synth
+
+#endif // PSTACK_SYNTH_WORKLOAD_HPP
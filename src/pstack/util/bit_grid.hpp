@@ -0,0 +1,106 @@
+#ifndef PSTACK_UTIL_BIT_GRID_HPP
+#define PSTACK_UTIL_BIT_GRID_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace pstack::util {
+
+// A 3D grid of bits, packed 64 to a word along the z axis.
+// Every (x, y) row starts on a fresh word, and the padding bits past the end of a row are always zero.
+class bit_grid {
+public:
+    using word_type = std::uint64_t;
+    static constexpr std::size_t word_bits = 64;
+
+    constexpr bit_grid() = default;
+
+    bit_grid(const std::size_t x, const std::size_t y, const std::size_t z)
+        : _extents{ x, y, z }
+        , _row_words((z + word_bits - 1) / word_bits)
+        , _words(x * y * _row_words, 0)
+    {}
+
+    constexpr std::size_t extent(const std::size_t dimension) const {
+        return _extents[dimension];
+    }
+
+    constexpr std::size_t row_words() const {
+        return _row_words;
+    }
+
+    // In bytes
+    std::size_t memory() const {
+        return _words.size() * sizeof(word_type);
+    }
+
+    // Every row, one after the other
+    std::span<word_type> words() {
+        return _words;
+    }
+
+    std::span<const word_type> words() const {
+        return _words;
+    }
+
+    std::span<word_type> row(const std::size_t x, const std::size_t y) {
+        return { _words.data() + (x * _extents[1] + y) * _row_words, _row_words };
+    }
+
+    std::span<const word_type> row(const std::size_t x, const std::size_t y) const {
+        return { _words.data() + (x * _extents[1] + y) * _row_words, _row_words };
+    }
+
+    bool test(const std::size_t x, const std::size_t y, const std::size_t z) const {
+        return (row(x, y)[z / word_bits] >> (z % word_bits)) & 1;
+    }
+
+    void set(const std::size_t x, const std::size_t y, const std::size_t z) {
+        row(x, y)[z / word_bits] |= word_type{1} << (z % word_bits);
+    }
+
+    // Returns the `word_bits` bits of row (x, y) starting at `z`. Bits past the end of the row read as zero.
+    word_type load(const std::size_t x, const std::size_t y, const std::size_t z) const {
+        const std::size_t index = z / word_bits;
+        const std::size_t shift = z % word_bits;
+        if (index >= _row_words) {
+            return 0;
+        }
+        const auto words = row(x, y);
+        word_type out = words[index] >> shift;
+        if (shift != 0 and index + 1 < _row_words) {
+            out |= words[index + 1] << (word_bits - shift);
+        }
+        return out;
+    }
+
+    // ORs `bits` into row (x, y) starting at `z`. Bits that would land past the end of the row are discarded.
+    void store_or(const std::size_t x, const std::size_t y, const std::size_t z, word_type bits) {
+        if (z >= _extents[2]) {
+            return;
+        }
+        const std::size_t remaining = _extents[2] - z;
+        if (remaining < word_bits) {
+            bits &= (word_type{1} << remaining) - 1;
+        }
+        const std::size_t index = z / word_bits;
+        const std::size_t shift = z % word_bits;
+        const auto words = row(x, y);
+        words[index] |= bits << shift;
+        if (shift != 0 and index + 1 < _row_words) {
+            words[index + 1] |= bits >> (word_bits - shift);
+        }
+    }
+
+private:
+    std::array<std::size_t, 3> _extents{};
+    std::size_t _row_words = 0;
+    std::vector<word_type> _words{};
+};
+
+} // namespace pstack::util
+
+#endif // PSTACK_UTIL_BIT_GRID_HPP
@@ -98,6 +98,10 @@ public:
         return _span.extent(dimension);
     }
 
+    constexpr std::size_t size() const {
+        return _data.size();
+    }
+
 private:
     std::vector<std::remove_const_t<T>> _data{};
     mdspan<T, Rank> _span{};
@@ -0,0 +1,122 @@
+#ifndef PSTACK_UTIL_THREAD_POOL_HPP
+#define PSTACK_UTIL_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace pstack::util {
+
+class thread_pool {
+public:
+    // `thread_count` includes the thread calling `for_each_index`. Zero means one thread per hardware thread.
+    thread_pool(std::size_t thread_count = 0) {
+        if (thread_count == 0) {
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        _workers.reserve(thread_count - 1);
+        for (std::size_t i = 1; i < thread_count; ++i) {
+            _workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~thread_pool() {
+        {
+            const std::lock_guard lock(_mutex);
+            _stopping = true;
+        }
+        _work_available.notify_all();
+        for (std::thread& worker : _workers) {
+            worker.join();
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    std::size_t size() const {
+        return _workers.size() + 1;
+    }
+
+    // Calls `fn(i)` for every `i` in `[0, count)`, and returns once all calls have returned.
+    // The calling thread takes part in the work, so this may be called from inside another `for_each_index`.
+    template <class F>
+    void for_each_index(const std::size_t count, F&& fn) {
+        if (_workers.empty() or count <= 1) {
+            for (std::size_t i = 0; i != count; ++i) {
+                fn(i);
+            }
+            return;
+        }
+
+        batch b{
+            .count = count,
+            .context = &fn,
+            .invoke = [](void* context, const std::size_t i) {
+                (*static_cast<std::remove_reference_t<F>*>(context))(i);
+            },
+        };
+        {
+            const std::lock_guard lock(_mutex);
+            _batches.push_back(&b);
+        }
+        _work_available.notify_all();
+
+        run(b);
+
+        std::unique_lock lock(_mutex);
+        std::erase(_batches, &b);
+        _batch_released.wait(lock, [&b] { return b.users == 0; });
+    }
+
+private:
+    struct batch {
+        std::size_t count;
+        void* context;
+        void (*invoke)(void*, std::size_t);
+        std::atomic<std::size_t> next = 0;
+        std::size_t users = 0; // Guarded by `_mutex`
+    };
+
+    static void run(batch& b) {
+        for (std::size_t i = b.next++; i < b.count; i = b.next++) {
+            b.invoke(b.context, i);
+        }
+    }
+
+    void work() {
+        std::unique_lock lock(_mutex);
+        while (true) {
+            _work_available.wait(lock, [this] { return _stopping or not _batches.empty(); });
+            if (_stopping) {
+                return;
+            }
+
+            batch& b = *_batches.front();
+            ++b.users;
+            lock.unlock();
+            run(b);
+            lock.lock();
+            std::erase(_batches, &b);
+            --b.users;
+            _batch_released.notify_all();
+        }
+    }
+
+    std::vector<std::thread> _workers{};
+    std::deque<batch*> _batches{};
+    std::mutex _mutex{};
+    std::condition_variable _work_available{};
+    std::condition_variable _batch_released{};
+    bool _stopping = false;
+};
+
+} // namespace pstack::util
+
+#endif // PSTACK_UTIL_THREAD_POOL_HPP
@@ -0,0 +1,136 @@
+#ifndef PSTACK_UTIL_TRACE_HPP
+#define PSTACK_UTIL_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace pstack::util {
+
+// Records spans of time on every thread, to be viewed in chrome://tracing or Perfetto.
+// Nothing is recorded until `start_trace`, and while stopped a span costs one atomic load.
+// Each thread appends to its own buffer without locking, so the trace must only be started and stopped while no spans are open.
+
+namespace trace_detail {
+
+using clock = std::chrono::steady_clock;
+
+struct event {
+    const char* name;
+    clock::time_point start;
+    clock::time_point end;
+};
+
+struct thread_buffer {
+    std::size_t thread_index;
+    std::deque<event> events{}; // Appending never moves earlier events
+};
+
+struct trace_state {
+    std::atomic<bool> enabled = false;
+    std::atomic<std::uint64_t> generation = 0; // Counts the traces started, so threads know when to get a fresh buffer
+    clock::time_point start{};
+    std::mutex mutex{};
+    std::vector<std::unique_ptr<thread_buffer>> buffers{}; // Guarded by `mutex`
+};
+
+inline trace_state global{};
+
+// The buffer of the calling thread, registered once per trace
+inline thread_buffer& local_buffer() {
+    struct local_state {
+        thread_buffer* buffer = nullptr;
+        std::uint64_t generation = 0;
+    };
+    static thread_local local_state local{};
+
+    const std::uint64_t generation = global.generation;
+    if (local.buffer == nullptr or local.generation != generation) {
+        const std::lock_guard lock(global.mutex);
+        local.buffer = global.buffers.emplace_back(new thread_buffer{ .thread_index = global.buffers.size() }).get();
+        local.generation = generation;
+    }
+    return *local.buffer;
+}
+
+} // namespace trace_detail
+
+inline bool trace_enabled() {
+    return trace_detail::global.enabled;
+}
+
+// Discards anything recorded before, and starts recording
+inline void start_trace() {
+    auto& global = trace_detail::global;
+    const std::lock_guard lock(global.mutex);
+    global.buffers.clear();
+    ++global.generation;
+    global.start = trace_detail::clock::now();
+    global.enabled = true;
+}
+
+// Stops recording, and writes what was recorded as trace event JSON. Returns whether the file could be written.
+inline bool stop_trace(const std::string& file_path) {
+    auto& global = trace_detail::global;
+    global.enabled = false;
+    const std::lock_guard lock(global.mutex);
+
+    std::FILE* file = std::fopen(file_path.c_str(), "w");
+    if (file == nullptr) {
+        global.buffers.clear();
+        return false;
+    }
+
+    const auto microseconds = [](const trace_detail::clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    };
+    std::fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    const char* separator = "\n";
+    for (const auto& buffer : global.buffers) {
+        std::fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %zu, \"args\": {\"name\": \"Thread %zu\"}}",
+            separator, buffer->thread_index, buffer->thread_index);
+        separator = ",\n";
+        for (const auto& [name, start, end] : buffer->events) {
+            std::fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %zu, \"ts\": %.3f, \"dur\": %.3f}",
+                name, buffer->thread_index, microseconds(start - global.start), microseconds(end - start));
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+    global.buffers.clear();
+    return std::fclose(file) == 0;
+}
+
+// Records the time from its construction to its destruction as a span on the calling thread.
+// `name` must outlive the trace, and is written as is, so it should be a string literal.
+class trace_scope {
+public:
+    explicit trace_scope(const char* name) {
+        if (trace_enabled()) {
+            _name = name;
+            _start = trace_detail::clock::now();
+        }
+    }
+
+    ~trace_scope() {
+        if (_name != nullptr and trace_enabled()) {
+            trace_detail::local_buffer().events.push_back({ _name, _start, trace_detail::clock::now() });
+        }
+    }
+
+    trace_scope(const trace_scope&) = delete;
+    trace_scope& operator=(const trace_scope&) = delete;
+
+private:
+    const char* _name = nullptr;
+    trace_detail::clock::time_point _start{};
+};
+
+} // namespace pstack::util
+
+#endif // PSTACK_UTIL_TRACE_HPP